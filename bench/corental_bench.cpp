@@ -0,0 +1,202 @@
+/**
+ * @file bench/corental_bench.cpp
+ *
+ * Measures the co-rental index on synthetic long rental histories: update
+ * cost per borrow, memory, query time, and how good its top neighbours
+ * are against exact co-occurrence counts kept in per-movie hash maps.
+ * Quality is the true co-rental count of the index's top N as a share of
+ * the exact top N's, which stays meaningful when the exact list has ties.
+ *
+ * Customers mostly rent within one taste cluster of titles, with a skew
+ * toward each cluster's first titles, so true neighbour lists have clear
+ * heavy hitters and a long tail.
+ *
+ * Usage: corental_bench [customers] [borrows per customer] [movies]
+ */
+
+#include "corental.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr size_t CLUSTER_SIZE = 100;
+constexpr size_t TOP_N = 5;
+constexpr size_t QUERY_SAMPLE = 1000;
+
+struct Borrow {
+  uint64_t customerID;
+  uint32_t movieIndex;
+};
+
+// Interleave customers so windows fill the way live traffic would
+std::vector<Borrow> makeWorkload(size_t customers, size_t perCustomer,
+                                 size_t movies) {
+  std::mt19937 rng(42);
+  size_t clusters = std::max<size_t>(movies / CLUSTER_SIZE, 1);
+  std::uniform_int_distribution<size_t> pickCluster(0, clusters - 1);
+  std::uniform_int_distribution<size_t> pickAny(0, movies - 1);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  std::vector<size_t> home(customers);
+  for (size_t &cluster : home) {
+    cluster = pickCluster(rng);
+  }
+
+  std::vector<Borrow> workload;
+  workload.reserve(customers * perCustomer);
+  for (size_t round = 0; round < perCustomer; round++) {
+    for (size_t c = 0; c < customers; c++) {
+      size_t movie;
+      if (unit(rng) < 0.8) {
+        // Squaring a uniform draw skews toward the cluster's first titles
+        double u = unit(rng);
+        size_t offset = static_cast<size_t>(u * u * CLUSTER_SIZE);
+        movie = std::min(home[c] * CLUSTER_SIZE + offset, movies - 1);
+      } else {
+        movie = pickAny(rng);
+      }
+      workload.push_back({c, static_cast<uint32_t>(movie)});
+    }
+  }
+  return workload;
+}
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+// Exact counts with the same windowing as CoRentalIndex
+class ExactCoRentals {
+public:
+  explicit ExactCoRentals(size_t movies) : counts(movies) {}
+
+  void recordBorrow(uint64_t customerID, uint32_t movieIndex) {
+    std::vector<uint32_t> &recent = windows[customerID];
+    if (std::find(recent.begin(), recent.end(), movieIndex) !=
+        recent.end()) {
+      return;
+    }
+    for (uint32_t other : recent) {
+      counts[movieIndex][other]++;
+      counts[other][movieIndex]++;
+    }
+    recent.push_back(movieIndex);
+    if (recent.size() > CoRentalIndex::WINDOW) {
+      recent.erase(recent.begin());
+    }
+  }
+
+  uint32_t count(uint32_t movieIndex, uint32_t other) const {
+    auto it = counts[movieIndex].find(other);
+    return it != counts[movieIndex].end() ? it->second : 0;
+  }
+
+  // Full neighbour scan, then a partial sort: O(neighbours)
+  std::vector<std::pair<uint32_t, uint32_t>> top(uint32_t movieIndex,
+                                                 size_t n) const {
+    std::vector<std::pair<uint32_t, uint32_t>> all;
+    for (const auto &entry : counts[movieIndex]) {
+      all.emplace_back(entry.second, entry.first);
+    }
+    n = std::min(n, all.size());
+    std::partial_sort(all.begin(), all.begin() + n, all.end(),
+                      std::greater<>());
+    all.resize(n);
+    return all;
+  }
+
+  // Approximate: bucket arrays plus one node (next, key, value) per entry
+  size_t memoryUsage() const {
+    size_t bytes = counts.capacity() * sizeof(counts[0]);
+    for (const auto &map : counts) {
+      bytes += map.bucket_count() * sizeof(void *) +
+               map.size() * (sizeof(void *) + 2 * sizeof(uint32_t));
+    }
+    return bytes;
+  }
+
+private:
+  std::vector<std::unordered_map<uint32_t, uint32_t>> counts;
+  std::unordered_map<uint64_t, std::vector<uint32_t>> windows;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t customers = argc > 1 ? std::atoi(argv[1]) : 5000;
+  size_t perCustomer = argc > 2 ? std::atoi(argv[2]) : 200;
+  size_t movies = argc > 3 ? std::atoi(argv[3]) : 10000;
+
+  std::vector<Borrow> workload = makeWorkload(customers, perCustomer, movies);
+
+  ExactCoRentals exact(movies);
+  auto start = std::chrono::steady_clock::now();
+  for (const Borrow &borrow : workload) {
+    exact.recordBorrow(borrow.customerID, borrow.movieIndex);
+  }
+  double exactMs = millisSince(start);
+
+  // Query cost and top-N agreement over a sample of titles
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<uint32_t> pick(0, movies - 1);
+  std::vector<uint32_t> sample(QUERY_SAMPLE);
+  for (uint32_t &movie : sample) {
+    movie = pick(rng);
+  }
+
+  size_t returned = 0;
+  start = std::chrono::steady_clock::now();
+  for (uint32_t movie : sample) {
+    returned += exact.top(movie, TOP_N).size();
+  }
+  double exactQueryNs = millisSince(start) * 1e6 / sample.size();
+
+  size_t borrows = workload.size();
+  std::cout << "structure,borrows,pair_updates,update_ns,memory_kb,"
+               "query_ns,top"
+            << TOP_N << "_quality\n";
+  for (size_t capacity : {16, 32, 64}) {
+    CoRentalIndex index(capacity);
+    start = std::chrono::steady_clock::now();
+    for (const Borrow &borrow : workload) {
+      index.recordBorrow(borrow.customerID, borrow.movieIndex);
+    }
+    double indexMs = millisSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t movie : sample) {
+      returned += index.neighbours(movie, TOP_N).size();
+    }
+    double indexQueryNs = millisSince(start) * 1e6 / sample.size();
+
+    uint64_t found = 0;
+    uint64_t best = 0;
+    for (uint32_t movie : sample) {
+      for (const CoRentalIndex::Neighbour &n : index.neighbours(movie, TOP_N)) {
+        found += exact.count(movie, n.movieIndex);
+      }
+      for (const auto &entry : exact.top(movie, TOP_N)) {
+        best += entry.first;
+      }
+    }
+
+    std::cout << "space_saving_k" << capacity << "," << borrows << ","
+              << index.getPairUpdates() << "," << indexMs * 1e6 / borrows
+              << "," << index.memoryUsage() / 1024 << "," << indexQueryNs
+              << ","
+              << (best > 0 ? static_cast<double>(found) / best : 1.0)
+              << "\n";
+  }
+
+  std::cout << "exact_hash_maps," << borrows << ",,"
+            << exactMs * 1e6 / borrows << "," << exact.memoryUsage() / 1024
+            << "," << exactQueryNs << ",1\n";
+  return returned > 0 ? 0 : 1;
+}
@@ -0,0 +1,359 @@
+/**
+ * @file bench/micro_bench.cpp
+ *
+ * Component timings for the core containers and the factories, next to
+ * the standard library equivalents:
+ *   BSTree      insert, find, findByPredicate and in-order traversal on
+ *               random and sorted keys, against std::map
+ *   HashTable   insert, find hit and find miss at several load factors,
+ *               and growth through resize(), against std::unordered_map
+ *   factories   MovieFactory::createMovie and CommandFactory::createCommand
+ *               against std::map dispatch and a plain switch
+ * Results are one row per measurement, as CSV or a JSON array, so runs of
+ * different builds can be diffed or loaded into a spreadsheet.
+ *
+ * Usage: micro_bench [--keys=N] [--format=csv|json]
+ */
+
+#include "bstree.h"
+#include "classic.h"
+#include "comedy.h"
+#include "commands.h"
+#include "drama.h"
+#include "factory.h"
+#include "hashtable.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Result {
+  std::string group;
+  std::string operation;
+  std::string structure;
+  std::string pattern;
+  size_t operations;
+  double nsPerOp;
+};
+
+std::vector<Result> results;
+
+// Keeps measured work from being optimized away
+volatile size_t sink;
+
+// Time body, which performs operations steps, and record ns per step
+template <typename Body>
+void measure(const std::string &group, const std::string &operation,
+             const std::string &structure, const std::string &pattern,
+             size_t operations, Body body) {
+  auto start = std::chrono::steady_clock::now();
+  body();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+  results.push_back({group, operation, structure, pattern, operations,
+                     ns / std::max<size_t>(operations, 1)});
+}
+
+bool compareInts(const int &a, const int &b) { return a < b; }
+
+void benchBSTree(const std::vector<int> &keys, const std::string &pattern) {
+  size_t n = keys.size();
+  std::vector<int> probes = keys;
+  std::shuffle(probes.begin(), probes.end(), std::mt19937(7));
+
+  BSTree<int> tree;
+  measure("bstree", "insert", "BSTree", pattern, n, [&] {
+    for (int key : keys) {
+      tree.insert(key, compareInts);
+    }
+  });
+  std::map<int, int> map;
+  measure("bstree", "insert", "std::map", pattern, n, [&] {
+    for (int key : keys) {
+      map.emplace(key, key);
+    }
+  });
+
+  std::function<int(const int &)> identity = [](const int &key) {
+    return key;
+  };
+  measure("bstree", "find", "BSTree", pattern, n, [&] {
+    size_t found = 0;
+    for (int key : probes) {
+      found += tree.find(key, identity) != nullptr ? 1 : 0;
+    }
+    sink = found;
+  });
+  measure("bstree", "find", "std::map", pattern, n, [&] {
+    size_t found = 0;
+    for (int key : probes) {
+      found += map.find(key) != map.end() ? 1 : 0;
+    }
+    sink = found;
+  });
+
+  // Linear, so only a sample of probes
+  size_t scans = std::min<size_t>(n, 200);
+  measure("bstree", "findByPredicate", "BSTree", pattern, scans, [&] {
+    size_t found = 0;
+    for (size_t i = 0; i < scans; i++) {
+      int wanted = probes[i];
+      found += tree.findByPredicate(
+                   [wanted](const int &key) { return key == wanted; }) !=
+                       nullptr
+                   ? 1
+                   : 0;
+    }
+    sink = found;
+  });
+  measure("bstree", "findByPredicate", "std::map scan", pattern, scans, [&] {
+    size_t found = 0;
+    for (size_t i = 0; i < scans; i++) {
+      int wanted = probes[i];
+      found += std::find_if(map.begin(), map.end(),
+                            [wanted](const auto &entry) {
+                              return entry.first == wanted;
+                            }) != map.end()
+                   ? 1
+                   : 0;
+    }
+    sink = found;
+  });
+
+  measure("bstree", "traverse", "BSTree", pattern, n, [&] {
+    size_t sum = 0;
+    tree.inOrderTraversal([&sum](const int &key) { sum += key; });
+    sink = sum;
+  });
+  measure("bstree", "traverse", "std::map", pattern, n, [&] {
+    size_t sum = 0;
+    for (const auto &entry : map) {
+      sum += entry.first;
+    }
+    sink = sum;
+  });
+}
+
+void benchHashTable(const std::vector<int> &keys) {
+  size_t n = keys.size();
+  std::vector<int> misses(n);
+  std::transform(keys.begin(), keys.end(), misses.begin(),
+                 [n](int key) { return key + static_cast<int>(n); });
+
+  // Presized so the table stays at the target load, below the resize point
+  for (double load : {0.25, 0.5, 0.75}) {
+    std::string pattern = "load " + std::to_string(load).substr(0, 4);
+    HashTable<int, int> table(static_cast<size_t>(n / load) + 1);
+    measure("hashtable", "insert", "HashTable", pattern, n, [&] {
+      for (int key : keys) {
+        table.insert(key, key);
+      }
+    });
+    measure("hashtable", "find hit", "HashTable", pattern, n, [&] {
+      size_t found = 0;
+      for (int key : keys) {
+        found += table.find(key) != nullptr ? 1 : 0;
+      }
+      sink = found;
+    });
+    measure("hashtable", "find miss", "HashTable", pattern, n, [&] {
+      size_t found = 0;
+      for (int key : misses) {
+        found += table.find(key) != nullptr ? 1 : 0;
+      }
+      sink = found;
+    });
+
+    std::unordered_map<int, int> map;
+    map.max_load_factor(static_cast<float>(load));
+    map.reserve(n);
+    measure("hashtable", "insert", "std::unordered_map", pattern, n, [&] {
+      for (int key : keys) {
+        map.emplace(key, key);
+      }
+    });
+    measure("hashtable", "find hit", "std::unordered_map", pattern, n, [&] {
+      size_t found = 0;
+      for (int key : keys) {
+        found += map.find(key) != map.end() ? 1 : 0;
+      }
+      sink = found;
+    });
+    measure("hashtable", "find miss", "std::unordered_map", pattern, n, [&] {
+      size_t found = 0;
+      for (int key : misses) {
+        found += map.find(key) != map.end() ? 1 : 0;
+      }
+      sink = found;
+    });
+  }
+
+  // From the default size, every doubling rehashes all entries so far
+  {
+    HashTable<int, int> table;
+    measure("hashtable", "insert growing", "HashTable", "default size", n,
+            [&] {
+              for (int key : keys) {
+                table.insert(key, key);
+              }
+            });
+    std::unordered_map<int, int> map;
+    measure("hashtable", "insert growing", "std::unordered_map",
+            "default size", n, [&] {
+              for (int key : keys) {
+                map.emplace(key, key);
+              }
+            });
+  }
+}
+
+void benchFactories(size_t n) {
+  const char genres[] = {'F', 'D', 'C'};
+  const char commands[] = {'B', 'R', 'I', 'H'};
+
+  measure("factory", "create movie", "MovieFactory", "F/D/C", n, [&] {
+    size_t created = 0;
+    for (size_t i = 0; i < n; i++) {
+      created +=
+          MovieFactory::getInstance().createMovie(genres[i % 3]) ? 1 : 0;
+    }
+    sink = created;
+  });
+
+  std::map<char, std::function<std::unique_ptr<Movie>()>> movieMap = {
+      {'F', [] { return std::make_unique<Comedy>(); }},
+      {'D', [] { return std::make_unique<Drama>(); }},
+      {'C', [] { return std::make_unique<Classic>(); }}};
+  measure("factory", "create movie", "std::map", "F/D/C", n, [&] {
+    size_t created = 0;
+    for (size_t i = 0; i < n; i++) {
+      created += movieMap.at(genres[i % 3])() ? 1 : 0;
+    }
+    sink = created;
+  });
+
+  measure("factory", "create movie", "switch", "F/D/C", n, [&] {
+    size_t created = 0;
+    for (size_t i = 0; i < n; i++) {
+      std::unique_ptr<Movie> movie;
+      switch (genres[i % 3]) {
+      case 'F':
+        movie = std::make_unique<Comedy>();
+        break;
+      case 'D':
+        movie = std::make_unique<Drama>();
+        break;
+      default:
+        movie = std::make_unique<Classic>();
+        break;
+      }
+      created += movie ? 1 : 0;
+    }
+    sink = created;
+  });
+
+  measure("factory", "create command", "CommandFactory", "B/R/I/H", n, [&] {
+    size_t created = 0;
+    for (size_t i = 0; i < n; i++) {
+      created += CommandFactory::getInstance().createCommand(
+                     commands[i % 4])
+                     ? 1
+                     : 0;
+    }
+    sink = created;
+  });
+
+  std::map<char, std::function<std::unique_ptr<Command>()>> commandMap = {
+      {'B', [] { return std::make_unique<BorrowCommand>(); }},
+      {'R', [] { return std::make_unique<ReturnCommand>(); }},
+      {'I', [] { return std::make_unique<InventoryCommand>(); }},
+      {'H', [] { return std::make_unique<HistoryCommand>(); }}};
+  measure("factory", "create command", "std::map", "B/R/I/H", n, [&] {
+    size_t created = 0;
+    for (size_t i = 0; i < n; i++) {
+      created += commandMap.at(commands[i % 4])() ? 1 : 0;
+    }
+    sink = created;
+  });
+}
+
+// Quote a field only if it needs it
+std::string csvField(const std::string &text) {
+  if (text.find_first_of(",\"") == std::string::npos) {
+    return text;
+  }
+  std::string quoted = "\"";
+  for (char c : text) {
+    quoted += (c == '"') ? "\"\"" : std::string(1, c);
+  }
+  return quoted + "\"";
+}
+
+void printCsv() {
+  std::cout << "group,operation,structure,pattern,operations,ns_per_op\n";
+  for (const Result &result : results) {
+    std::cout << result.group << "," << csvField(result.operation) << ","
+              << csvField(result.structure) << ","
+              << csvField(result.pattern) << "," << result.operations << ","
+              << result.nsPerOp << "\n";
+  }
+}
+
+// Names here never hold quotes or backslashes
+void printJson() {
+  std::cout << "[\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    std::cout << "  {\"group\": \"" << result.group << "\", \"operation\": \""
+              << result.operation << "\", \"structure\": \""
+              << result.structure << "\", \"pattern\": \"" << result.pattern
+              << "\", \"operations\": " << result.operations
+              << ", \"ns_per_op\": " << result.nsPerOp << "}"
+              << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  std::cout << "]\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t n = 100000;
+  bool json = false;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.compare(0, 7, "--keys=") == 0) {
+      n = std::strtoul(arg.c_str() + 7, nullptr, 10);
+    } else if (arg == "--format=json") {
+      json = true;
+    } else if (arg != "--format=csv") {
+      std::cerr << "Usage: " << argv[0] << " [--keys=N] [--format=csv|json]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<int> sorted(n);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  std::vector<int> random = sorted;
+  std::shuffle(random.begin(), random.end(), std::mt19937(42));
+
+  benchBSTree(random, "random");
+  benchBSTree(sorted, "sorted");
+  benchHashTable(random);
+  benchFactories(n);
+
+  if (json) {
+    printJson();
+  } else {
+    printCsv();
+  }
+  return 0;
+}
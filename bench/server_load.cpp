@@ -0,0 +1,266 @@
+/**
+ * @file bench/server_load.cpp
+ *
+ * Load generator for the command server (see runit-server.sh). Opens a
+ * number of idle connections that never send, then runs busy clients in
+ * parallel threads, each sending command lines one at a time and waiting
+ * for the "." line that ends each response. Reader clients meanwhile
+ * send Inventory commands back to back, to load the server with long
+ * reads. Prints one CSV row with the busy clients' throughput and
+ * round-trip latency percentiles, overall and for Borrow and Return.
+ *
+ * Usage: server_load --socket=PATH [--clients=N] [--requests=M] [--idle=K]
+ *                    [--readers=R] [--commands=FILE]
+ *   --clients   busy clients (default 4)
+ *   --requests  requests per busy client (default 1000)
+ *   --idle      idle connections held open during the run (default 0)
+ *   --readers   clients sending only Inventory commands (default 0)
+ *   --commands  command lines to cycle through (default data4commands.txt)
+ */
+
+#include "commandstats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Connected socket, or -1
+int connectTo(const std::string &path) {
+  struct sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    return -1;
+  }
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  if (connect(fd, reinterpret_cast<struct sockaddr *>(&address),
+              sizeof(address)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool sendAll(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t written = write(fd, data.data() + sent, data.size() - sent);
+    if (written <= 0) {
+      return false;
+    }
+    sent += static_cast<size_t>(written);
+  }
+  return true;
+}
+
+// Read until pending holds a whole response, then drop it from pending.
+// Only newly read text is searched, as an Inventory runs to megabytes.
+bool readResponse(int fd, std::string &pending) {
+  char buffer[64 * 1024];
+  size_t searched = 0;
+  for (;;) {
+    if (pending.compare(0, 2, ".\n") == 0) {
+      pending.erase(0, 2);
+      return true;
+    }
+    size_t end = pending.find("\n.\n", searched);
+    if (end != std::string::npos) {
+      pending.erase(0, end + 3);
+      return true;
+    }
+    searched = (pending.size() > 2) ? pending.size() - 2 : 0;
+    ssize_t count = read(fd, buffer, sizeof(buffer));
+    if (count <= 0) {
+      return false;
+    }
+    pending.append(buffer, static_cast<size_t>(count));
+  }
+}
+
+struct Client {
+  LatencyHistogram latencies;      // Microseconds per round trip
+  LatencyHistogram shortLatencies; // Borrow and Return only
+  uint64_t failures = 0;
+};
+
+bool isShortCommand(const std::string &line) {
+  size_t typeAt = line.find_first_not_of(" \t");
+  return typeAt != std::string::npos &&
+         (line[typeAt] == 'B' || line[typeAt] == 'R');
+}
+
+void runClient(const std::string &path, const std::vector<std::string> &lines,
+               size_t first, size_t requests, Client &client) {
+  int fd = connectTo(path);
+  if (fd < 0) {
+    client.failures = requests;
+    return;
+  }
+  std::string pending;
+  for (size_t i = 0; i < requests; i++) {
+    const std::string &line = lines[(first + i) % lines.size()];
+    auto start = Clock::now();
+    if (!sendAll(fd, line + "\n") || !readResponse(fd, pending)) {
+      client.failures += requests - i;
+      break;
+    }
+    auto elapsed = Clock::now() - start;
+    uint64_t micros = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+            .count());
+    client.latencies.record(micros);
+    if (isShortCommand(line)) {
+      client.shortLatencies.record(micros);
+    }
+  }
+  close(fd);
+}
+
+// Send Inventory commands until stopped, counting them
+void runReader(const std::string &path, const std::atomic<bool> &stop,
+               uint64_t &requests) {
+  int fd = connectTo(path);
+  if (fd < 0) {
+    return;
+  }
+  std::string pending;
+  while (!stop && sendAll(fd, "I\n") && readResponse(fd, pending)) {
+    requests++;
+  }
+  close(fd);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string socketPath;
+  std::string commandFile = "data4commands.txt";
+  size_t clientCount = 4;
+  size_t requests = 1000;
+  size_t idleCount = 0;
+  size_t readerCount = 0;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t equals = arg.find('=');
+    std::string name = arg.substr(0, equals);
+    std::string value =
+        (equals == std::string::npos) ? "" : arg.substr(equals + 1);
+    if (name == "--socket") {
+      socketPath = value;
+    } else if (name == "--clients") {
+      clientCount = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--requests") {
+      requests = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--idle") {
+      idleCount = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--readers") {
+      readerCount = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--commands") {
+      commandFile = value;
+    } else {
+      socketPath.clear();
+      break;
+    }
+  }
+  if (socketPath.empty() || clientCount == 0) {
+    std::cerr << "Usage: " << argv[0]
+              << " --socket=PATH [--clients=N] [--requests=M] [--idle=K]"
+                 " [--readers=R] [--commands=FILE]"
+              << std::endl;
+    return 1;
+  }
+
+  std::ifstream file(commandFile);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.find_first_not_of(" \t\r") != std::string::npos) {
+      lines.push_back(line);
+    }
+  }
+  if (lines.empty()) {
+    std::cerr << "Error: No commands in " << commandFile << std::endl;
+    return 1;
+  }
+
+  // Idle connections stay open, unused, until the busy clients finish
+  std::vector<int> idle;
+  for (size_t i = 0; i < idleCount; i++) {
+    int fd = connectTo(socketPath);
+    if (fd < 0) {
+      std::cerr << "Error: Could only open " << idle.size()
+                << " idle connections" << std::endl;
+      break;
+    }
+    idle.push_back(fd);
+  }
+
+  std::atomic<bool> stopReaders(false);
+  std::vector<uint64_t> readerRequests(readerCount, 0);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < readerCount; i++) {
+    readers.emplace_back(runReader, std::cref(socketPath),
+                         std::cref(stopReaders), std::ref(readerRequests[i]));
+  }
+
+  auto start = Clock::now();
+  std::vector<Client> clients(clientCount);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < clientCount; i++) {
+    // Start each client at a different line so they do not move in step
+    threads.emplace_back(runClient, std::cref(socketPath), std::cref(lines),
+                         i * lines.size() / clientCount, requests,
+                         std::ref(clients[i]));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  stopReaders = true;
+  uint64_t reads = 0;
+  for (size_t i = 0; i < readerCount; i++) {
+    readers[i].join();
+    reads += readerRequests[i];
+  }
+
+  for (int fd : idle) {
+    close(fd);
+  }
+
+  LatencyHistogram all;
+  LatencyHistogram borrowReturn;
+  uint64_t failures = 0;
+  for (const Client &client : clients) {
+    all.merge(client.latencies);
+    borrowReturn.merge(client.shortLatencies);
+    failures += client.failures;
+  }
+
+  std::cout << "clients,idle,readers,reads,requests,failures,seconds,"
+               "requests_per_sec,p50_us,p90_us,p99_us,max_us,br_p99_us,"
+               "br_max_us\n"
+            << clientCount << "," << idle.size() << "," << readerCount << ","
+            << reads << "," << all.getCount() << "," << failures << ","
+            << seconds << "," << all.getCount() / seconds << ","
+            << all.percentile(0.50) << "," << all.percentile(0.90) << ","
+            << all.percentile(0.99) << "," << all.getMax() << ","
+            << borrowReturn.percentile(0.99) << "," << borrowReturn.getMax()
+            << std::endl;
+  return (failures == 0) ? 0 : 1;
+}
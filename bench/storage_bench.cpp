@@ -0,0 +1,165 @@
+/**
+ * @file bench/storage_bench.cpp
+ *
+ * Compares tree storage of heap-allocated movies against flat per-genre
+ * storage for inventory rendering and movie lookup.
+ *
+ * The two gains are measured apart. Lookups compare the tree's scan with
+ * flat storage's key table, and involve no dispatch. The second table
+ * renders the same flat records twice: through the Movie interface, one
+ * virtual call per record, and through the genre store, which calls the
+ * final record type directly. The difference between them is the cost of
+ * the virtual calls; the tree's inventory time also includes its scattered
+ * nodes.
+ *
+ * Usage: storage_bench [movies per genre] [lookups]
+ */
+
+#include "factory.h"
+#include "flatstore.h"
+#include "formatbuffer.h"
+#include "store.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Stream buffer that discards output, so rendering cost is measured alone
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override { return c; }
+  std::streamsize xsputn(const char * /*s*/, std::streamsize n) override {
+    return n;
+  }
+};
+
+const char *const MOVIE_FILE = "/tmp/storage_bench_movies.txt";
+const char *const CUSTOMER_FILE = "/tmp/storage_bench_customers.txt";
+
+// Write a catalog with count titles per genre, returning Comedy search keys
+std::vector<std::string> writeCatalog(int count) {
+  std::ofstream movies(MOVIE_FILE);
+  std::vector<std::string> keys;
+  for (int i = 0; i < count; i++) {
+    int year = 1950 + i % 70;
+    std::string title = "Title " + std::to_string(i * 7919 % count);
+    std::string director = "Director " + std::to_string(i % 500);
+    movies << "F, 10, " << director << ", " << title << ", " << year << "\n";
+    movies << "D, 10, " << director << ", " << title << ", " << year << "\n";
+    movies << "C, 10, " << director << ", " << title << ", Actor"
+           << i % 1000 << " Last" << i % 37 << " " << (i % 12 + 1) << " "
+           << year << "\n";
+    keys.push_back(title + "," + std::to_string(year));
+  }
+
+  std::ofstream customers(CUSTOMER_FILE);
+  customers << "1000 Bench Customer\n";
+  return keys;
+}
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+void run(const char *name, bool flat, const std::vector<std::string> &keys,
+         int lookups) {
+  Store store;
+  store.useFlatStorage(flat);
+
+  auto start = std::chrono::steady_clock::now();
+  store.initialize(MOVIE_FILE, CUSTOMER_FILE);
+  double loadMs = millisSince(start);
+
+  NullBuffer buffer;
+  std::ostream out(&buffer);
+  store.displayInventory(out); // Warm up (flat storage sorts lazily)
+  start = std::chrono::steady_clock::now();
+  store.displayInventory(out);
+  double inventoryMs = millisSince(start);
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+  int found = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < lookups; i++) {
+    found += store.findMovie('F', keys[pick(rng)]) != nullptr ? 1 : 0;
+  }
+  double lookupNs = millisSince(start) * 1e6 / lookups;
+
+  std::cout << name << "," << keys.size() * 3 << "," << loadMs << ","
+            << inventoryMs << "," << lookupNs << "," << found << "\n";
+}
+
+// Render one flat genre per row, with and without virtual calls per record
+void runDispatch() {
+  std::vector<std::unique_ptr<GenreStore>> stores;
+  for (char genre : {'F', 'D', 'C'}) {
+    stores.push_back(MovieFactory::getInstance().createGenreStore(genre));
+  }
+  std::ifstream movies(MOVIE_FILE);
+  std::string line;
+  size_t count = 0;
+  while (std::getline(movies, line)) {
+    std::istringstream iss(line);
+    char genre;
+    char comma;
+    iss >> genre >> comma;
+    std::unique_ptr<Movie> movie =
+        MovieFactory::getInstance().createMovie(genre);
+    if (movie && movie->parseData(iss)) {
+      stores[genre == 'F' ? 0 : genre == 'D' ? 1 : 2]->add(std::move(movie));
+      count++;
+    }
+  }
+
+  NullBuffer buffer;
+  std::ostream out(&buffer);
+  for (const auto &store : stores) {
+    store->display(out); // Warm up and sort
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  FormatBuffer text;
+  for (const auto &store : stores) {
+    store->forEachSorted([&](const Movie *movie) {
+      movie->format(text);
+      text << '\n';
+      text.flushIfFull(out);
+    });
+  }
+  text.flushTo(out);
+  double virtualMs = millisSince(start);
+
+  start = std::chrono::steady_clock::now();
+  for (const auto &store : stores) {
+    store->display(out);
+  }
+  double staticMs = millisSince(start);
+
+  std::cout << "dispatch,movies,inventory_ms\n";
+  std::cout << "virtual," << count << "," << virtualMs << "\n";
+  std::cout << "static," << count << "," << staticMs << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int perGenre = argc > 1 ? std::atoi(argv[1]) : 20000;
+  int lookups = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+  std::vector<std::string> keys = writeCatalog(perGenre);
+  std::cout << "storage,movies,load_ms,inventory_ms,lookup_ns,found\n";
+  run("tree", false, keys, lookups);
+  run("flat", true, keys, lookups);
+  runDispatch();
+  return 0;
+}
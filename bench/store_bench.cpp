@@ -0,0 +1,113 @@
+/**
+ * @file bench/store_bench.cpp
+ *
+ * End-to-end throughput of Store::initialize and Store::processCommands on
+ * a directory of input files (see workload_gen). Command output is
+ * discarded so the store's own cost is measured, not the terminal's.
+ *
+ * Usage: store_bench [--wide-ids] [--flat] DIR
+ */
+
+#include "store.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <sys/resource.h>
+
+namespace {
+
+// Stream buffer that discards output
+class NullBuffer : public std::streambuf {
+protected:
+  int overflow(int c) override { return c; }
+  std::streamsize xsputn(const char * /*s*/, std::streamsize n) override {
+    return n;
+  }
+};
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+// Largest resident set so far, in KB
+long peakRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+size_t countLines(const std::string &filename) {
+  std::ifstream file(filename);
+  size_t lines = 0;
+  std::string line;
+  while (std::getline(file, line)) {
+    lines++;
+  }
+  return lines;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bool wideIDs = false;
+  bool flat = false;
+  std::string directory;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--wide-ids") {
+      wideIDs = true;
+    } else if (arg == "--flat") {
+      flat = true;
+    } else if (directory.empty()) {
+      directory = arg;
+    } else {
+      directory.clear();
+      break;
+    }
+  }
+  if (directory.empty()) {
+    std::cerr << "Usage: " << argv[0] << " [--wide-ids] [--flat] DIR"
+              << std::endl;
+    return 1;
+  }
+
+  const std::string movieFile = directory + "/data4movies.txt";
+  const std::string customerFile = directory + "/data4customers.txt";
+  const std::string commandFile = directory + "/data4commands.txt";
+  size_t commands = countLines(commandFile);
+
+  NullBuffer nullBuffer;
+  std::streambuf *coutBuffer = std::cout.rdbuf(&nullBuffer);
+  std::streambuf *cerrBuffer = std::cerr.rdbuf(&nullBuffer);
+
+  Store store;
+  store.useWideCustomerIDs(wideIDs);
+  store.useFlatStorage(flat);
+
+  auto start = std::chrono::steady_clock::now();
+  bool loaded = store.initialize(movieFile, customerFile);
+  double loadMs = millisSince(start);
+  long loadRssKb = peakRssKb();
+
+  start = std::chrono::steady_clock::now();
+  bool processed = loaded && store.processCommands(commandFile);
+  double commandMs = millisSince(start);
+
+  std::cout.rdbuf(coutBuffer);
+  std::cerr.rdbuf(cerrBuffer);
+  if (!processed) {
+    std::cerr << "Failed to run the workload in " << directory << std::endl;
+    return 1;
+  }
+
+  std::cout << "storage,load_ms,load_rss_kb,commands,command_ms,"
+               "commands_per_sec,peak_rss_kb\n";
+  std::cout << (flat ? "flat" : "tree") << "," << loadMs << "," << loadRssKb
+            << "," << commands << "," << commandMs << ","
+            << static_cast<long long>(commands / (commandMs / 1000.0)) << ","
+            << peakRssKb() << "\n";
+  return 0;
+}
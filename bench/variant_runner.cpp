@@ -0,0 +1,176 @@
+/**
+ * @file bench/variant_runner.cpp
+ *
+ * Runs every runit-without-*.sh variant in one process and checks each
+ * against its output-without-*.txt baseline. Instead of a build that
+ * leaves a registrar's source file out, each variant is a Store with that
+ * command type or genre masked off. The variants run in parallel threads,
+ * each writing to its own buffer.
+ *
+ * Usage: variant_runner [DIR]
+ *   DIR holds the data files and the baselines (default .)
+ */
+
+#include "store.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// A build of the store without one registrar
+struct Variant {
+  const char *name;
+  const char *commandTypes; // Command types masked off
+  const char *movieTypes;   // Genres masked off
+};
+
+const Variant VARIANTS[] = {{"borrow", "B", ""},
+                            {"classic", "", "C"},
+                            {"comedy", "", "F"},
+                            {"history", "H", ""},
+                            {"return", "R", ""}};
+
+struct Result {
+  std::string output;
+  double millis = 0;
+};
+
+// Same steps and messages as main, with output and errors interleaved in
+// one buffer as they are in the baselines
+void runVariant(const Variant &variant, const std::string &directory,
+                Result &result) {
+  auto start = std::chrono::steady_clock::now();
+  std::ostringstream buffer;
+
+  Store store;
+  store.setOutput(buffer, buffer);
+  for (const char *type = variant.commandTypes; *type != '\0'; type++) {
+    store.disableCommandType(*type);
+  }
+  for (const char *type = variant.movieTypes; *type != '\0'; type++) {
+    store.disableMovieType(*type);
+  }
+
+  if (!store.initialize(directory + "/data4movies.txt",
+                        directory + "/data4customers.txt")) {
+    buffer << "Failed to initialize store with data files" << std::endl;
+  } else if (!store.processCommands(directory + "/data4commands.txt")) {
+    buffer << "Failed to process command file" << std::endl;
+  } else {
+    buffer << "Done!" << std::endl;
+  }
+
+  result.output = buffer.str();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  result.millis = std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+std::vector<std::string> splitLines(const std::string &text) {
+  std::vector<std::string> lines;
+  std::istringstream input(text);
+  std::string line;
+  while (std::getline(input, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+// Baseline lines after the banner the runit script prints once the
+// program compiles; false if the file cannot be read
+bool readBaseline(const std::string &filename,
+                  std::vector<std::string> &lines) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  std::stringstream contents;
+  contents << file.rdbuf();
+  lines = splitLines(contents.str());
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    if (lines[i].compare(0, 22, "Compilation successful") != 0) {
+      continue;
+    }
+    // The banner ends with the next rule
+    for (size_t j = i + 1; j < lines.size(); j++) {
+      if (lines[j].compare(0, 5, "=====") == 0) {
+        lines.erase(lines.begin(), lines.begin() + j + 1);
+        return true;
+      }
+    }
+  }
+  return true;
+}
+
+// Describe the first line that differs to out, true if there is none
+bool compareLines(const std::vector<std::string> &expected,
+                  const std::vector<std::string> &actual, std::ostream &out) {
+  size_t count = std::max(expected.size(), actual.size());
+  for (size_t i = 0; i < count; i++) {
+    const std::string *want = (i < expected.size()) ? &expected[i] : nullptr;
+    const std::string *got = (i < actual.size()) ? &actual[i] : nullptr;
+    if (want != nullptr && got != nullptr && *want == *got) {
+      continue;
+    }
+    out << "  line " << i + 1 << "\n";
+    out << "  expected: " << (want ? *want : "<end of file>") << "\n";
+    out << "  actual:   " << (got ? *got : "<end of output>") << "\n";
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 2) {
+    std::cerr << "Usage: " << argv[0] << " [DIR]" << std::endl;
+    return 1;
+  }
+  const std::string directory = (argc == 2) ? argv[1] : ".";
+
+  auto start = std::chrono::steady_clock::now();
+  const size_t count = sizeof(VARIANTS) / sizeof(VARIANTS[0]);
+  std::vector<Result> results(count);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < count; i++) {
+    threads.emplace_back(runVariant, std::cref(VARIANTS[i]),
+                         std::cref(directory), std::ref(results[i]));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  int failures = 0;
+  for (size_t i = 0; i < count; i++) {
+    const std::string baseline =
+        directory + "/output-without-" + VARIANTS[i].name + ".txt";
+    std::vector<std::string> expected;
+    bool passed = false;
+    std::cout << "without-" << VARIANTS[i].name << ": ";
+    if (!readBaseline(baseline, expected)) {
+      std::cout << "FAIL\n  could not read " << baseline << "\n";
+    } else {
+      std::vector<std::string> actual = splitLines(results[i].output);
+      std::ostringstream details;
+      passed = compareLines(expected, actual, details);
+      std::cout << (passed ? "PASS" : "FAIL") << " (" << actual.size()
+                << " lines, " << results[i].millis << " ms)\n"
+                << details.str();
+    }
+    failures += passed ? 0 : 1;
+  }
+
+  std::cout << count - failures << " of " << count << " variants passed in "
+            << std::chrono::duration<double, std::milli>(elapsed).count()
+            << " ms" << std::endl;
+  return (failures == 0) ? 0 : 1;
+}
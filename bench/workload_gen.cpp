@@ -0,0 +1,299 @@
+/**
+ * @file bench/workload_gen.cpp
+ *
+ * Writes data4movies.txt, data4customers.txt and data4commands.txt in the
+ * store's input formats at a chosen scale and mix, for sizing runs with
+ * store_bench.
+ *
+ * Usage: workload_gen [options] DIR
+ *   --titles=N     titles per genre (default 10000)
+ *   --customers=M  customers (default 5000); over 9000 needs wide IDs
+ *   --commands=C   command lines (default 200000)
+ *   --mix=B:R:I:H  relative weights of Borrow, Return, Inventory and
+ *                  History (default 60:35:1:4)
+ *   --invalid=P    share of command and movie lines made invalid
+ *                  (default 0.01)
+ *   --zipf=S       Zipf exponent of title popularity, 0 for uniform
+ *                  (default 1.0)
+ *   --stock=K      copies per title (default 10)
+ *   --seed=X       random seed (default 1)
+ *
+ * The generator tracks the copies left of each title and the rentals still
+ * out, so every Borrow it writes has a copy to take and every Return names
+ * a rental that is out; the only commands that fail are the --invalid ones.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+  size_t titles = 10000;
+  size_t customers = 5000;
+  size_t commands = 200000;
+  double mix[4] = {60, 35, 1, 4};
+  double invalid = 0.01;
+  double zipf = 1.0;
+  int stock = 10;
+  unsigned seed = 1;
+  std::string directory;
+};
+
+// Narrow IDs are four digits starting at 1000
+constexpr size_t MAX_NARROW_CUSTOMERS = 9000;
+
+bool parseMix(const std::string &text, double mix[4]) {
+  size_t start = 0;
+  for (int i = 0; i < 4; i++) {
+    size_t end = (i < 3) ? text.find(':', start) : text.size();
+    if (end == std::string::npos) {
+      return false;
+    }
+    mix[i] = std::atof(text.substr(start, end - start).c_str());
+    start = end + 1;
+  }
+  return mix[0] + mix[1] + mix[2] + mix[3] > 0;
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t equals = arg.find('=');
+    std::string name = arg.substr(0, equals);
+    std::string value =
+        (equals == std::string::npos) ? "" : arg.substr(equals + 1);
+
+    if (name == "--titles") {
+      options.titles = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--customers") {
+      options.customers = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--commands") {
+      options.commands = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "--mix") {
+      if (!parseMix(value, options.mix)) {
+        return false;
+      }
+    } else if (name == "--invalid") {
+      options.invalid = std::atof(value.c_str());
+    } else if (name == "--zipf") {
+      options.zipf = std::atof(value.c_str());
+    } else if (name == "--stock") {
+      options.stock = std::atoi(value.c_str());
+    } else if (name == "--seed") {
+      options.seed = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (arg.compare(0, 2, "--") != 0 && options.directory.empty()) {
+      options.directory = arg;
+    } else {
+      return false;
+    }
+  }
+  return !options.directory.empty() && options.titles > 0 &&
+         options.customers > 0 && options.stock > 0;
+}
+
+// Title i of a genre; genre letters keep Comedy and Drama titles distinct
+std::string titleName(char genre, size_t i) {
+  return std::string("Title ") + genre + std::to_string(i);
+}
+
+std::string directorName(size_t i) {
+  return "Director " + std::to_string(i % 997);
+}
+
+int releaseYear(size_t i) { return 1930 + static_cast<int>(i % 90); }
+
+// Classic keys are month, year and actor, so each title gets its own actor
+std::string actorName(size_t i) {
+  return "Actor" + std::to_string(i) + " Star";
+}
+
+int releaseMonth(size_t i) { return static_cast<int>(i % 12) + 1; }
+
+// Tries at a popular title before a Borrow gives way to a Return
+constexpr int BORROW_ATTEMPTS = 16;
+
+// Search key as Borrow and Return expect it
+std::string searchKey(char genre, size_t i) {
+  switch (genre) {
+  case 'F':
+    return titleName('F', i) + ", " + std::to_string(releaseYear(i));
+  case 'D':
+    return directorName(i) + ", " + titleName('D', i) + ",";
+  default:
+    return std::to_string(releaseMonth(i)) + " " +
+           std::to_string(releaseYear(i)) + " " + actorName(i);
+  }
+}
+
+std::string customerID(size_t i, bool wide) {
+  return std::to_string(wide ? 100000 + i : 1000 + i);
+}
+
+void writeMovies(const Options &options, std::mt19937 &rng) {
+  std::ofstream out(options.directory + "/data4movies.txt");
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  for (size_t i = 0; i < options.titles; i++) {
+    std::string stock = std::to_string(options.stock);
+    out << "F, " << stock << ", " << directorName(i) << ", "
+        << titleName('F', i) << ", " << releaseYear(i) << "\n";
+    out << "D, " << stock << ", " << directorName(i) << ", "
+        << titleName('D', i) << ", " << releaseYear(i) << "\n";
+    out << "C, " << stock << ", " << directorName(i) << ", "
+        << titleName('C', i) << ", " << actorName(i) << " "
+        << releaseMonth(i) << " " << releaseYear(i) << "\n";
+    if (unit(rng) < options.invalid) {
+      out << "Z, " << stock << ", " << directorName(i) << ", "
+          << titleName('Z', i) << ", " << releaseYear(i) << "\n";
+    }
+  }
+}
+
+void writeCustomers(const Options &options, bool wide) {
+  std::ofstream out(options.directory + "/data4customers.txt");
+  for (size_t i = 0; i < options.customers; i++) {
+    out << customerID(i, wide) << " Last" << i << " First" << i << "\n";
+  }
+}
+
+// One of the ways a command line goes wrong in real input files
+void writeInvalidCommand(std::ofstream &out, std::mt19937 &rng, bool wide) {
+  std::uniform_int_distribution<int> kind(0, 3);
+  switch (kind(rng)) {
+  case 0:
+    out << "X\n"; // Unknown command
+    break;
+  case 1:
+    out << "B " << (wide ? "999999999" : "9999") << " D F "
+        << searchKey('F', 0) << "\n"; // Unknown customer
+    break;
+  case 2:
+    out << "B " << customerID(0, wide) << " Q F " << searchKey('F', 0)
+        << "\n"; // Bad media type
+    break;
+  default:
+    out << "B " << customerID(0, wide) << " D F No Such Title, 1900\n";
+    break;
+  }
+}
+
+// Returns the number of invalid command lines written
+size_t writeCommands(const Options &options, std::mt19937 &rng, bool wide) {
+  std::ofstream out(options.directory + "/data4commands.txt");
+  const char genres[] = {'F', 'D', 'C'};
+
+  // Zipf weights over every title, ranked in a shuffled order so hot
+  // titles are spread across genres
+  size_t titleCount = options.titles * 3;
+  std::vector<size_t> rankToTitle(titleCount);
+  for (size_t i = 0; i < titleCount; i++) {
+    rankToTitle[i] = i;
+  }
+  std::shuffle(rankToTitle.begin(), rankToTitle.end(), rng);
+  std::vector<double> weights(titleCount);
+  for (size_t rank = 0; rank < titleCount; rank++) {
+    weights[rank] = 1.0 / std::pow(static_cast<double>(rank + 1), options.zipf);
+  }
+  std::discrete_distribution<size_t> pickRank(weights.begin(), weights.end());
+
+  std::discrete_distribution<int> pickCommand(options.mix, options.mix + 4);
+  std::uniform_int_distribution<size_t> pickCustomer(0, options.customers - 1);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  // Copies on the shelf and rentals still out, as the store will have
+  // them, so borrows find stock and returns name something borrowed
+  struct Rental {
+    size_t customer;
+    size_t title;
+  };
+  std::vector<int> copiesLeft(titleCount, options.stock);
+  std::vector<Rental> outstanding;
+  size_t invalidCommands = 0;
+
+  for (size_t line = 0; line < options.commands; line++) {
+    if (unit(rng) < options.invalid) {
+      writeInvalidCommand(out, rng, wide);
+      invalidCommands++;
+      continue;
+    }
+
+    int command = pickCommand(rng);
+    if (command == 1 && outstanding.empty()) {
+      command = 0;
+    }
+
+    // A Borrow needs a title with a copy left; when the popular ones are
+    // all out, return one instead
+    size_t title = 0;
+    if (command == 0) {
+      int attempt = 0;
+      do {
+        title = rankToTitle[pickRank(rng)];
+      } while (copiesLeft[title] == 0 && ++attempt < BORROW_ATTEMPTS);
+      if (copiesLeft[title] == 0) {
+        command = 1;
+      }
+    }
+
+    if (command == 0) {
+      Rental rental = {pickCustomer(rng), title};
+      copiesLeft[title]--;
+      outstanding.push_back(rental);
+      char genre = genres[rental.title % 3];
+      out << "B " << customerID(rental.customer, wide) << " D " << genre
+          << " " << searchKey(genre, rental.title / 3) << "\n";
+    } else if (command == 1) {
+      std::uniform_int_distribution<size_t> pickRental(0,
+                                                       outstanding.size() - 1);
+      size_t index = pickRental(rng);
+      Rental rental = outstanding[index];
+      outstanding[index] = outstanding.back();
+      outstanding.pop_back();
+      copiesLeft[rental.title]++;
+      char genre = genres[rental.title % 3];
+      out << "R " << customerID(rental.customer, wide) << " D " << genre
+          << " " << searchKey(genre, rental.title / 3) << "\n";
+    } else if (command == 2) {
+      out << "I\n";
+    } else {
+      out << "H " << customerID(pickCustomer(rng), wide) << "\n";
+    }
+  }
+  return invalidCommands;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--titles=N] [--customers=M] [--commands=C]"
+                 " [--mix=B:R:I:H] [--invalid=P] [--zipf=S] [--stock=K]"
+                 " [--seed=X] DIR"
+              << std::endl;
+    return 1;
+  }
+
+  bool wide = options.customers > MAX_NARROW_CUSTOMERS;
+  std::mt19937 rng(options.seed);
+  writeMovies(options, rng);
+  writeCustomers(options, wide);
+  size_t invalidCommands = writeCommands(options, rng, wide);
+
+  std::cout << "Wrote " << options.titles * 3 << " titles, "
+            << options.customers << " customers and " << options.commands
+            << " commands (" << invalidCommands << " invalid) to "
+            << options.directory << "\n";
+  if (wide) {
+    std::cout << "Customer IDs are wider than 4 digits; run store_bench "
+                 "with --wide-ids\n";
+  }
+  return 0;
+}
@@ -34,6 +34,23 @@ g++ -I./header -g -Wall -Wextra -Wno-sign-compare *.cpp \
     src/comedy.cpp \
     src/drama.cpp \
     src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
     src/inventory_command.cpp \
     src/history_command.cpp \
     src/borrow_command.cpp \
@@ -58,6 +75,23 @@ if hash clang-tidy 2>/dev/null; then
     src/comedy.cpp \
     src/drama.cpp \
     src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
     src/inventory_command.cpp \
     src/history_command.cpp \
     src/borrow_command.cpp \
@@ -81,6 +115,23 @@ if hash clang-format 2>/dev/null; then
     src/comedy.cpp \
     src/drama.cpp \
     src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
     src/inventory_command.cpp \
     src/history_command.cpp \
     src/borrow_command.cpp \
@@ -104,6 +155,23 @@ g++ -I./header -fsanitize=address -fno-omit-frame-pointer -g *.cpp \
     src/comedy.cpp \
     src/drama.cpp \
     src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
     src/inventory_command.cpp \
     src/history_command.cpp \
     src/borrow_command.cpp \
@@ -125,6 +193,23 @@ if hash valgrind 2>/dev/null; then
     src/comedy.cpp \
     src/drama.cpp \
     src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
     src/inventory_command.cpp \
     src/history_command.cpp \
     src/borrow_command.cpp \
@@ -155,6 +240,23 @@ if hash gcov 2>/dev/null; then
     src/comedy.cpp \
     src/drama.cpp \
     src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
     src/inventory_command.cpp \
     src/history_command.cpp \
     src/borrow_command.cpp \
@@ -179,6 +281,23 @@ if hash gcov 2>/dev/null; then
     
     # Process source directory files
     for file in src/classic.cpp src/comedy.cpp src/drama.cpp src/store.cpp \
+                src/top_command.cpp \
+                src/director_command.cpp \
+                src/actor_command.cpp \
+                src/prefix_command.cpp \
+                src/stock_command.cpp \
+                src/encoder.cpp \
+                src/deltawatcher.cpp \
+                src/delta_command.cpp \
+                src/retire_command.cpp \
+                src/close_command.cpp \
+                src/corental_command.cpp \
+                src/stats_command.cpp \
+                src/alloctracker.cpp \
+                src/commandlog.cpp \
+                src/server.cpp \
+                src/scheduler.cpp \
+                src/workpool.cpp \
                 src/inventory_command.cpp src/history_command.cpp \
                 src/borrow_command.cpp src/return_command.cpp; do
       if [ -f "$file" ]; then
@@ -198,6 +317,23 @@ if hash gcov 2>/dev/null; then
       src/comedy.cpp \
       src/drama.cpp \
       src/store.cpp \
+      src/top_command.cpp \
+      src/director_command.cpp \
+      src/actor_command.cpp \
+      src/prefix_command.cpp \
+      src/stock_command.cpp \
+      src/encoder.cpp \
+      src/deltawatcher.cpp \
+      src/delta_command.cpp \
+      src/retire_command.cpp \
+      src/close_command.cpp \
+      src/corental_command.cpp \
+      src/stats_command.cpp \
+      src/alloctracker.cpp \
+      src/commandlog.cpp \
+      src/server.cpp \
+      src/scheduler.cpp \
+      src/workpool.cpp \
       src/inventory_command.cpp \
       src/history_command.cpp \
       src/borrow_command.cpp \
@@ -0,0 +1,124 @@
+/**
+ * @location header/alloctracker.h
+ */
+
+#ifndef ALLOCTRACKER_H
+#define ALLOCTRACKER_H
+
+// Heap allocation counts attributed to what the program was doing.
+//
+// Build with -DSTORE_ALLOC_TRACKING to replace the global operator new and
+// delete (see src/alloctracker.cpp). Every allocation is then charged to
+// the calling thread's current phase and command type, set by
+// ALLOC_SCOPE and ALLOC_SCOPE_COMMAND (at most one per block, as the scope
+// object has a fixed name). A table of allocations, bytes and frees per
+// phase and command, with averages per run, is printed to stderr at exit.
+// Without the flag the macros expand to nothing.
+
+#ifdef STORE_ALLOC_TRACKING
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class AllocTracker {
+public:
+  enum Phase {
+    OTHER,
+    LOAD_MOVIES,
+    LOAD_CUSTOMERS,
+    PARSE_COMMAND,
+    EXECUTE_COMMAND,
+    NUM_PHASES
+  };
+
+  // What the calling thread is doing
+  struct Tag {
+    Phase phase;
+    char commandType; // '\0' outside commands
+  };
+
+  static Tag &currentTag() {
+    thread_local Tag tag = {OTHER, '\0'};
+    return tag;
+  }
+
+  static void recordAllocation(size_t bytes) {
+    Counters &counters = countersFor(currentTag());
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  static void recordFree() {
+    countersFor(currentTag()).frees.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Count entries into a scope, for per-run averages; -1 takes one back
+  static void recordRun(const Tag &tag, int delta = 1) {
+    countersFor(tag).runs.fetch_add(static_cast<uint64_t>(delta),
+                                    std::memory_order_relaxed);
+  }
+
+  // Print the table to stderr. Type '-' is work outside any command, or
+  // parsing before the command letter is read; its runs move to the letter.
+  static void report();
+
+private:
+  struct Counters {
+    std::atomic<uint64_t> runs;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> frees;
+  };
+
+  static constexpr size_t COMMAND_TYPES = 128;
+
+  // Zero-initialized before any allocation can happen
+  static Counters table[NUM_PHASES][COMMAND_TYPES];
+
+  static Counters &countersFor(const Tag &tag) {
+    return table[tag.phase]
+                [static_cast<unsigned char>(tag.commandType) % COMMAND_TYPES];
+  }
+};
+
+// Charges allocations on this thread to a phase until the scope ends
+class AllocScope {
+public:
+  explicit AllocScope(AllocTracker::Phase phase, char commandType = '\0')
+      : previous(AllocTracker::currentTag()) {
+    AllocTracker::currentTag() = {phase, commandType};
+    AllocTracker::recordRun(AllocTracker::currentTag());
+  }
+
+  ~AllocScope() { AllocTracker::currentTag() = previous; }
+
+  // Name the command once its type has been read; the run moves with it
+  void setCommandType(char commandType) {
+    AllocTracker::Tag &tag = AllocTracker::currentTag();
+    AllocTracker::recordRun(tag, -1);
+    tag.commandType = commandType;
+    AllocTracker::recordRun(tag);
+  }
+
+  AllocScope(const AllocScope &) = delete;
+  AllocScope &operator=(const AllocScope &) = delete;
+
+private:
+  AllocTracker::Tag previous;
+};
+
+#define ALLOC_SCOPE(phase) AllocScope allocScope(AllocTracker::phase)
+#define ALLOC_SCOPE_COMMAND(phase, type)                                      \
+  AllocScope allocScope(AllocTracker::phase, type)
+#define ALLOC_SCOPE_SET_COMMAND(type) allocScope.setCommandType(type)
+
+#else
+
+#define ALLOC_SCOPE(phase)
+#define ALLOC_SCOPE_COMMAND(phase, type)
+#define ALLOC_SCOPE_SET_COMMAND(type)
+
+#endif // STORE_ALLOC_TRACKING
+
+#endif // ALLOCTRACKER_H
@@ -0,0 +1,102 @@
+/**
+ * @location header/bloomfilter.h
+ */
+
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Bloom filter over strings for rejecting definite misses before a lookup
+class BloomFilter {
+public:
+  // Lookups split into rejected (definite miss), hits and false positives
+  struct Stats {
+    size_t lookups = 0;
+    size_t rejected = 0;
+    size_t falsePositives = 0;
+
+    size_t hits() const { return lookups - rejected - falsePositives; }
+  };
+
+  explicit BloomFilter(size_t expectedItems = 64) { reset(expectedItems); }
+
+  // Clear all bits and size for expectedItems keys (counters are kept)
+  void reset(size_t expectedItems) {
+    itemCapacity = std::max<size_t>(expectedItems, 1);
+    numBits = itemCapacity * BITS_PER_ITEM;
+    bits.assign((numBits + 63) / 64, 0);
+    numItems = 0;
+  }
+
+  void insert(const std::string &key) {
+    insertHash(std::hash<std::string>{}(key));
+  }
+  void insert(uint64_t key) { insertHash(mixInteger(key)); }
+
+  // False means key was never inserted; true means it might have been
+  bool mayContain(const std::string &key) {
+    return mayContainHash(std::hash<std::string>{}(key));
+  }
+  bool mayContain(uint64_t key) { return mayContainHash(mixInteger(key)); }
+
+  // Caller found nothing after mayContain returned true
+  void recordFalsePositive() { stats.falsePositives++; }
+
+  const Stats &getStats() const { return stats; }
+  size_t size() const { return numItems; }
+  size_t capacity() const { return itemCapacity; }
+
+private:
+  // 10 bits and 7 hashes per item give about a 1% false positive rate
+  static constexpr size_t BITS_PER_ITEM = 10;
+  static constexpr size_t NUM_HASHES = 7;
+
+  std::vector<uint64_t> bits;
+  size_t numBits;
+  size_t numItems;
+  size_t itemCapacity;
+  Stats stats;
+
+  void insertHash(uint64_t h1) {
+    uint64_t h2 = secondHash(h1);
+    for (size_t i = 0; i < NUM_HASHES; i++) {
+      uint64_t bit = (h1 + i * h2) % numBits;
+      bits[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+    numItems++;
+  }
+
+  bool mayContainHash(uint64_t h1) {
+    stats.lookups++;
+    uint64_t h2 = secondHash(h1);
+    for (size_t i = 0; i < NUM_HASHES; i++) {
+      uint64_t bit = (h1 + i * h2) % numBits;
+      if ((bits[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+        stats.rejected++;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Integer keys are often sequential, so scramble them first
+  static uint64_t mixInteger(uint64_t key) {
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+  }
+
+  // Derive an odd step for double hashing from the first hash
+  static uint64_t secondHash(uint64_t h) {
+    h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h | 1;
+  }
+};
+
+#endif // BLOOMFILTER_H
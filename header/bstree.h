@@ -5,23 +5,74 @@
 #ifndef BSTREE_H
 #define BSTREE_H
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
+#include <vector>
 
-// BST for maintaining sorted collections
+// BST for maintaining sorted collections, kept height-balanced (AVL)
 template <typename T> class BSTree {
 private:
   struct Node {
     T data;
     Node *left;
     Node *right;
+    int height;
 
-    explicit Node(const T &item) : data(item), left(nullptr), right(nullptr) {}
+    explicit Node(const T &item)
+        : data(item), left(nullptr), right(nullptr), height(1) {}
   };
 
   Node *root;
   size_t nodeCount;
 
+  static int height(const Node *node) {
+    return (node != nullptr) ? node->height : 0;
+  }
+
+  static void updateHeight(Node *node) {
+    node->height = 1 + std::max(height(node->left), height(node->right));
+  }
+
+  static Node *rotateRight(Node *node) {
+    Node *pivot = node->left;
+    node->left = pivot->right;
+    pivot->right = node;
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
+  }
+
+  static Node *rotateLeft(Node *node) {
+    Node *pivot = node->right;
+    node->right = pivot->left;
+    pivot->left = node;
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
+  }
+
+  // Restore the AVL invariant at node; rotations keep in-order sequence,
+  // so equal items stay in insertion order
+  static Node *rebalance(Node *node) {
+    updateHeight(node);
+    int balance = height(node->left) - height(node->right);
+
+    if (balance > 1) {
+      if (height(node->left->left) < height(node->left->right)) {
+        node->left = rotateLeft(node->left);
+      }
+      return rotateRight(node);
+    }
+    if (balance < -1) {
+      if (height(node->right->right) < height(node->right->left)) {
+        node->right = rotateRight(node->right);
+      }
+      return rotateLeft(node);
+    }
+    return node;
+  }
+
   // Recursive insertion
   Node *insertHelper(Node *node, const T &item,
                      std::function<bool(const T &, const T &)> compare) {
@@ -36,7 +87,57 @@ private:
       node->right = insertHelper(node->right, item, compare);
     }
 
-    return node;
+    return rebalance(node);
+  }
+
+  // Detach the leftmost node below node into min, returning the new subtree
+  static Node *detachMin(Node *node, Node *&min) {
+    if (node->left == nullptr) {
+      min = node;
+      return node->right;
+    }
+    node->left = detachMin(node->left, min);
+    return rebalance(node);
+  }
+
+  // Recursive removal of the node holding exactly item; equal items may
+  // sit on either side after rotations, so both are searched
+  Node *eraseHelper(Node *node, const T &item,
+                    const std::function<bool(const T &, const T &)> &compare,
+                    bool &erased) {
+    if (node == nullptr) {
+      return nullptr;
+    }
+
+    if (compare(item, node->data)) {
+      node->left = eraseHelper(node->left, item, compare, erased);
+    } else if (compare(node->data, item)) {
+      node->right = eraseHelper(node->right, item, compare, erased);
+    } else if (!(node->data == item)) {
+      node->left = eraseHelper(node->left, item, compare, erased);
+      if (!erased) {
+        node->right = eraseHelper(node->right, item, compare, erased);
+      }
+    } else {
+      erased = true;
+      nodeCount--;
+      Node *left = node->left;
+      Node *right = node->right;
+      delete node;
+
+      if (right == nullptr) {
+        return left;
+      }
+
+      // The in-order successor takes the removed node's place
+      Node *successor = nullptr;
+      right = detachMin(right, successor);
+      successor->left = left;
+      successor->right = right;
+      return rebalance(successor);
+    }
+
+    return rebalance(node);
   }
 
   // Find by key using extractor function
@@ -75,22 +176,23 @@ private:
     }
   }
 
-  // Find by custom predicate (for non-BST ordered searches)
+  // Find by custom predicate (for non-BST ordered searches); searched in
+  // order so the first match does not depend on the tree's shape
   T *findByPredicateHelper(Node *node,
                            std::function<bool(const T &)> predicate) const {
     if (node == nullptr) {
       return nullptr;
     }
 
-    if (predicate(node->data)) {
-      return &(node->data);
-    }
-
     T *leftResult = findByPredicateHelper(node->left, predicate);
     if (leftResult != nullptr) {
       return leftResult;
     }
 
+    if (predicate(node->data)) {
+      return &(node->data);
+    }
+
     return findByPredicateHelper(node->right, predicate);
   }
 
@@ -108,6 +210,15 @@ public:
     root = insertHelper(root, item, compare);
   }
 
+  // Remove the element equal (==) to item, located with the same
+  // comparison used to insert it; false if it is not in the tree
+  bool erase(const T &item,
+             std::function<bool(const T &, const T &)> compare) {
+    bool erased = false;
+    root = eraseHelper(root, item, compare, erased);
+    return erased;
+  }
+
   // Find by key using extractor
   template <typename K>
   T *find(const K &key, std::function<K(const T &)> keyExtractor) const {
@@ -124,8 +235,89 @@ public:
     inOrderHelper(root, visit);
   }
 
+  // In-order position that can stop between elements and resume later,
+  // e.g. to render a large genre a slice at a time. Valid while no
+  // elements are inserted or erased.
+  class Cursor {
+  public:
+    explicit Cursor(const BSTree &tree) { descendLeft(tree.root); }
+
+    bool done() const { return path.empty(); }
+    const T &current() const { return path.back()->data; }
+
+    void advance() {
+      const Node *node = path.back();
+      path.pop_back();
+      descendLeft(node->right);
+    }
+
+  private:
+    // Nodes whose left subtree has been visited but not themselves
+    std::vector<const Node *> path;
+
+    void descendLeft(const Node *node) {
+      for (; node != nullptr; node = node->left) {
+        path.push_back(node);
+      }
+    }
+  };
+
+  Cursor cursor() const { return Cursor(*this); }
+
+  // Consecutive part of the in-order sequence: a whole subtree, or one
+  // element on its own
+  class Range {
+  public:
+    Range() : node(nullptr), subtree(false) {}
+
+  private:
+    friend class BSTree;
+    Node *node;
+    bool subtree;
+
+    Range(Node *node, bool subtree) : node(node), subtree(subtree) {}
+  };
+
+  // The in-order sequence as consecutive ranges: subtrees no taller than
+  // maxHeight and the elements between them. Ranges may be traversed on
+  // separate threads while the tree is not modified.
+  std::vector<Range> split(int maxHeight) const {
+    std::vector<Range> ranges;
+    splitHelper(root, maxHeight, ranges);
+    return ranges;
+  }
+
+  // Visit the elements of one range in sorted order
+  void inOrderTraversal(const Range &range,
+                        std::function<void(const T &)> visit) const {
+    if (range.subtree) {
+      inOrderHelper(range.node, visit);
+    } else if (range.node != nullptr) {
+      visit(range.node->data);
+    }
+  }
+
+  int getHeight() const { return height(root); }
+
   bool empty() const { return root == nullptr; }
   size_t size() const { return nodeCount; }
+
+private:
+  // Append node's subtree to ranges, splitting it into its two halves and
+  // the element between while it is taller than maxHeight
+  static void splitHelper(Node *node, int maxHeight,
+                          std::vector<Range> &ranges) {
+    if (node == nullptr) {
+      return;
+    }
+    if (node->height <= maxHeight) {
+      ranges.push_back(Range(node, true));
+      return;
+    }
+    splitHelper(node->left, maxHeight, ranges);
+    ranges.push_back(Range(node, false));
+    splitHelper(node->right, maxHeight, ranges);
+  }
 };
 
 #endif // BSTREE_H
\ No newline at end of file
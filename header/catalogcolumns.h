@@ -0,0 +1,79 @@
+/**
+ * @location header/catalogcolumns.h
+ */
+
+#ifndef CATALOGCOLUMNS_H
+#define CATALOGCOLUMNS_H
+
+#include "movie.h"
+#include <cstdint>
+#include <vector>
+
+// Column-wise copy of per-movie numbers for whole-catalog scans. Row i is
+// the movie with catalog index i; each column is a dense array so scans
+// touch only the bytes they need and compile to vectorizable loops.
+class CatalogColumns {
+public:
+  // Append a row for movie, returning its catalog index
+  uint32_t add(Movie *movie) {
+    stock.push_back(movie->getStock());
+    year.push_back(static_cast<int16_t>(movie->getYear()));
+    genre.push_back(movie->getMovieType());
+    active.push_back(1);
+    movies.push_back(movie);
+    return static_cast<uint32_t>(movies.size() - 1);
+  }
+
+  // Refresh a row after its movie's stock changed
+  void updateStock(uint32_t index, int newStock) { stock[index] = newStock; }
+
+  // Leave a retired movie's row out of scans; the row itself stays so
+  // catalog indexes remain valid
+  void retire(uint32_t index) { active[index] = 0; }
+
+  // Copies on the shelf for one genre
+  int64_t totalStock(char movieType) const {
+    int64_t total = 0;
+    const size_t count = stock.size();
+    for (size_t i = 0; i < count; i++) {
+      total += (genre[i] == movieType && active[i] != 0) ? stock[i] : 0;
+    }
+    return total;
+  }
+
+  // Number of titles with fewer than threshold copies on the shelf
+  size_t countStockBelow(int threshold) const {
+    size_t count = 0;
+    const size_t rows = stock.size();
+    for (size_t i = 0; i < rows; i++) {
+      count += (stock[i] < threshold && active[i] != 0) ? 1 : 0;
+    }
+    return count;
+  }
+
+  // Movies with fewer than threshold copies, in catalog order
+  std::vector<Movie *> stockBelow(int threshold) const {
+    std::vector<Movie *> result;
+    result.reserve(countStockBelow(threshold));
+    const size_t count = stock.size();
+    for (size_t i = 0; i < count; i++) {
+      if (stock[i] < threshold && active[i] != 0) {
+        result.push_back(movies[i]);
+      }
+    }
+    return result;
+  }
+
+  bool isActive(uint32_t index) const { return active[index] != 0; }
+  Movie *movieAt(uint32_t index) const { return movies[index]; }
+  size_t size() const { return movies.size(); }
+
+private:
+  std::vector<int32_t> stock;
+  std::vector<int16_t> year;
+  std::vector<char> genre;
+  std::vector<uint8_t> active; // 0 once retired
+  std::vector<Movie *> movies; // Catalog index to movie
+};
+
+#endif // CATALOGCOLUMNS_H
@@ -7,14 +7,14 @@
 
 #include "movie.h"
 
-class Classic : public Movie {
+class Classic final : public Movie {
 public:
   Classic();
   virtual ~Classic() = default;
 
   // Display for inventory: Release date, Major actor, Director, Title (Stock)
   // - Classics
-  void display(std::ostream &out) const override;
+  void format(FormatBuffer &out) const override;
 
   // Sort key: "YYYYMM ActorFirstName ActorLastName"
   std::string getSortingKey() const override;
@@ -37,12 +37,41 @@ public:
   // Virtual constructor
   Movie *clone() const override;
 
+  int getReleaseMonth() const override { return releaseMonth; }
+
+  // Major actors: "FirstName LastName", primary actor first
+  std::vector<std::string> getMajorActors() const override;
+  size_t getActorCount() const override { return 1 + otherActors.size(); }
+  void forEachActor(const ActorVisitor &visit) const override;
+
+  // One "M YYYY FirstName LastName" key per major actor
+  std::vector<std::string> getSearchKeys() const override;
+
+  // Match a search key for any of the major actors
+  bool matchesSearchKey(const std::string &key) const override;
+
+  // "Title,Director,M YYYY": one physical film, whatever the actor
+  std::string getConsolidationKey() const override;
+
+  // Add the other row's actors and pool its stock
+  void mergeFrom(const Movie &other) override;
+
 private:
-  std::string actorFirstName;
-  std::string actorLastName;
+  struct Actor {
+    InternedString firstName;
+    InternedString lastName;
+  };
+
+  InternedString actorFirstName; // Primary actor, used for sorting
+  InternedString actorLastName;
+  std::vector<Actor> otherActors; // Filled only for consolidated records
   int releaseMonth;
   int releaseYear;
 
+  // Search key for one actor
+  std::string searchKeyFor(const InternedString &firstName,
+                           const InternedString &lastName) const;
+
   // Convert month/year to YYYYMM format for sorting
   std::string getReleaseDateSortKey() const;
 };
@@ -7,13 +7,13 @@
 
 #include "movie.h"
 
-class Comedy : public Movie {
+class Comedy final : public Movie {
 public:
   Comedy();
   virtual ~Comedy() = default;
 
   // Display for inventory: Title, Year, Director (Stock) - Comedy
-  void display(std::ostream &out) const override;
+  void format(FormatBuffer &out) const override;
 
   // Sort key: "Title YYYY"
   std::string getSortingKey() const override;
@@ -5,9 +5,11 @@
 #ifndef COMMAND_H
 #define COMMAND_H
 
+#include "slicedreport.h"
 #include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <memory>
 #include <string>
 
 // Forward declaration
@@ -20,14 +22,23 @@ public:
   // Execute the command on the store
   virtual bool execute(Store &store) = 0;
 
+  // Execute for a scheduler that runs long reads in slices: a long read
+  // writes its first lines and returns the rest as a report, with
+  // succeeded set; other commands run execute and return nullptr
+  virtual std::unique_ptr<SlicedReport> start(Store &store, bool &succeeded) {
+    succeeded = execute(store);
+    return nullptr;
+  }
+
   // Return command type code: 'B', 'R', 'I', 'H'
   virtual char getCommandType() const = 0;
 
   // Virtual constructor pattern
   virtual Command *clone() const = 0;
 
-  // Parse parameters from input stream
-  virtual bool setParameters(std::istream &input) = 0;
+  // Parse parameters from input stream, for the store that will run the
+  // command (its genre mask and error output)
+  virtual bool setParameters(std::istream &input, const Store &store) = 0;
 
   // Get description for error messages
   virtual std::string getDescription() const = 0;
@@ -35,9 +46,10 @@ public:
 protected:
   Command() = default;
 
-  // Validate 4-digit customer ID
+  // Check a customer ID is 1 to 19 digits; the store decides which
+  // lengths it accepts (see Store::isValidCustomerID)
   static bool isValidCustomerID(const std::string &id) {
-    if (id.length() != 4) {
+    if (id.empty() || id.length() > 19) {
       return false;
     }
     return std::all_of(id.begin(), id.end(),
@@ -48,10 +60,10 @@ protected:
   static bool isValidMediaType(char mediaType) { return mediaType == 'D'; }
 
   // Print error with consistent formatting
-  static void reportError(const std::string &message) {
-    std::cerr << "==========================\n";
-    std::cerr << message << "\n";
-    std::cerr << "==========================\n";
+  static void reportError(std::ostream &err, const std::string &message) {
+    err << "==========================\n";
+    err << message << "\n";
+    err << "==========================\n";
   }
 };
 
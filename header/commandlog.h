@@ -0,0 +1,152 @@
+/**
+ * @location header/commandlog.h
+ */
+
+#ifndef COMMANDLOG_H
+#define COMMANDLOG_H
+
+#include "formatbuffer.h"
+#include <cstdint>
+#include <fstream>
+#include <streambuf>
+#include <string>
+
+// 64-bit FNV-1a hash of everything passed to update, in order
+class StreamHash {
+public:
+  void update(const char *bytes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      hash ^= static_cast<unsigned char>(bytes[i]);
+      hash *= 1099511628211ULL;
+    }
+  }
+
+  uint64_t value() const { return hash; }
+
+private:
+  uint64_t hash = 14695981039346656037ULL;
+};
+
+// Stream buffer that hashes what is written through it and passes it on
+// to target, or discards it if target is null. It keeps no buffer of its
+// own, so streams sharing one hash are hashed in the order they write.
+class HashingStreamBuffer : public std::streambuf {
+public:
+  HashingStreamBuffer(std::streambuf *target, StreamHash &hash)
+      : target(target), hash(hash) {}
+
+protected:
+  int overflow(int c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    char byte = traits_type::to_char_type(c);
+    hash.update(&byte, 1);
+    if (target != nullptr &&
+        traits_type::eq_int_type(target->sputc(byte), traits_type::eof())) {
+      return traits_type::eof();
+    }
+    return c;
+  }
+
+  std::streamsize xsputn(const char *bytes, std::streamsize count) override {
+    hash.update(bytes, static_cast<size_t>(count));
+    return (target != nullptr) ? target->sputn(bytes, count) : count;
+  }
+
+  int sync() override { return (target != nullptr) ? target->pubsync() : 0; }
+
+private:
+  std::streambuf *target;
+  StreamHash &hash;
+};
+
+// Output and state hashes once a number of commands have run
+struct CommandLogCheckpoint {
+  uint64_t commands = 0;
+  uint64_t outputHash = 0;
+  uint64_t stateHash = 0;
+
+  bool operator==(const CommandLogCheckpoint &other) const {
+    return commands == other.commands && outputHash == other.outputHash &&
+           stateHash == other.stateHash;
+  }
+  bool operator!=(const CommandLogCheckpoint &other) const {
+    return !(*this == other);
+  }
+};
+
+// A command stream captured for replay, split into command type and
+// arguments at capture time so replay does no line scanning. Integers are
+// little-endian:
+//   header      "STORELOG", u16 version
+//   command     'C', u32 microseconds since the previous command arrived,
+//               type char ('\0' for a line without one), u32 argument
+//               length, argument bytes (the rest of the line after the type)
+//   checkpoint  'K', u64 commands so far, u64 output hash, u64 state hash
+class CommandLogWriter {
+public:
+  // Create or truncate filename and write the header
+  bool open(const std::string &filename);
+
+  void writeCommand(uint32_t gapMicros, char commandType,
+                    const std::string &arguments);
+  void writeCheckpoint(const CommandLogCheckpoint &checkpoint);
+
+  // Write out anything buffered, false if any write failed
+  bool close();
+
+private:
+  std::ofstream file;
+  FormatBuffer buffer;
+
+  void writeInteger(uint64_t value, int bytes);
+};
+
+// Reads a whole log into memory, then hands out its records in order
+class CommandLogReader {
+public:
+  struct Record {
+    enum Kind { COMMAND, CHECKPOINT };
+    Kind kind = COMMAND;
+    uint32_t gapMicros = 0;
+    char commandType = '\0';
+    std::string arguments;
+    CommandLogCheckpoint checkpoint;
+  };
+
+  // False if filename cannot be read or is not a command log
+  bool open(const std::string &filename);
+
+  // Next record, false at the end of the log or on a damaged record
+  bool next(Record &record);
+
+  // True once next has stopped on a damaged record
+  bool isDamaged() const { return damaged; }
+
+private:
+  std::string contents;
+  size_t position = 0;
+  bool damaged = false;
+
+  bool readInteger(uint64_t &value, int bytes);
+};
+
+// How Store::replayCommands paces a log
+struct ReplayOptions {
+  // Multiple of the captured timing, e.g. 2 for twice as fast; 0 replays
+  // as fast as possible
+  double speed = 0;
+};
+
+// What a replay did, and the first checkpoint that did not match
+struct ReplayReport {
+  uint64_t commands = 0;
+  double elapsedMillis = 0;
+  uint64_t checkpointsMatched = 0;
+  uint64_t checkpointsDiverged = 0;
+  CommandLogCheckpoint expected; // First divergence, if any
+  CommandLogCheckpoint actual;
+};
+
+#endif // COMMANDLOG_H
@@ -6,8 +6,11 @@
 #define COMMANDS_H
 
 #include "command.h"
+#include "encoder.h"
 #include <string>
 
+class Customer;
+
 /**
  * @brief Command to display entire movie inventory
  */
@@ -17,10 +20,14 @@ public:
   virtual ~InventoryCommand() = default;
 
   bool execute(Store &store) override;
+  std::unique_ptr<SlicedReport> start(Store &store, bool &succeeded) override;
   char getCommandType() const override;
   Command *clone() const override;
-  bool setParameters(std::istream &input) override;
+  bool setParameters(std::istream &input, const Store &store) override;
   std::string getDescription() const override;
+
+private:
+  OutputFormat format = OutputFormat::DEFAULT;
 };
 
 /**
@@ -32,13 +39,19 @@ public:
   virtual ~HistoryCommand() = default;
 
   bool execute(Store &store) override;
+  std::unique_ptr<SlicedReport> start(Store &store, bool &succeeded) override;
   char getCommandType() const override;
   Command *clone() const override;
-  bool setParameters(std::istream &input) override;
+  bool setParameters(std::istream &input, const Store &store) override;
   std::string getDescription() const override;
 
 private:
   std::string customerID;
+  OutputFormat format = OutputFormat::DEFAULT;
+
+  // Check the customer and write the text header, reporting any error;
+  // nullptr if the history cannot be shown
+  Customer *findCustomer(Store &store) const;
 };
 
 /**
@@ -52,7 +65,7 @@ public:
   bool execute(Store &store) override;
   char getCommandType() const override;
   Command *clone() const override;
-  bool setParameters(std::istream &input) override;
+  bool setParameters(std::istream &input, const Store &store) override;
   std::string getDescription() const override;
 
 private:
@@ -74,7 +87,7 @@ public:
   bool execute(Store &store) override;
   char getCommandType() const override;
   Command *clone() const override;
-  bool setParameters(std::istream &input) override;
+  bool setParameters(std::istream &input, const Store &store) override;
   std::string getDescription() const override;
 
 private:
@@ -85,4 +98,189 @@ private:
   std::string movieTitle; // For error messages
 };
 
+/**
+ * @brief Command to display the most borrowed titles of a genre
+ */
+class TopCommand : public Command {
+public:
+  TopCommand();
+  virtual ~TopCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  char movieType;
+  int count;
+};
+
+/**
+ * @brief Command to list every title by a director across genres
+ */
+class DirectorCommand : public Command {
+public:
+  DirectorCommand() = default;
+  virtual ~DirectorCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  std::string director;
+};
+
+/**
+ * @brief Command to list every title featuring a major actor
+ */
+class ActorCommand : public Command {
+public:
+  ActorCommand() = default;
+  virtual ~ActorCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  std::string actor;
+};
+
+/**
+ * @brief Command to autocomplete titles, directors and actors by prefix
+ */
+class PrefixCommand : public Command {
+public:
+  PrefixCommand() = default;
+  virtual ~PrefixCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  std::string prefix;
+};
+
+/**
+ * @brief Command to list titles running low on stock: 'L' for fewer than
+ * a threshold of copies, 'O' for none at all
+ */
+class StockReportCommand : public Command {
+public:
+  explicit StockReportCommand(char commandType);
+  virtual ~StockReportCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  char commandType;
+  int threshold;
+};
+
+/**
+ * @brief Command to ingest a movie ('M') or customer ('C') delta file,
+ * named without a path, from the watched delta directory
+ */
+class DeltaCommand : public Command {
+public:
+  DeltaCommand() : deltaType('\0') {}
+  virtual ~DeltaCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  char deltaType;
+  std::string filename;
+};
+
+/**
+ * @brief Command to retire a title from inventory
+ */
+class RetireCommand : public Command {
+public:
+  RetireCommand() : movieType('\0') {}
+  virtual ~RetireCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  char movieType;
+  std::string movieSearchKey;
+};
+
+/**
+ * @brief Command to list titles most often rented alongside a title
+ */
+class CoRentalCommand : public Command {
+public:
+  CoRentalCommand();
+  virtual ~CoRentalCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  char movieType;
+  std::string movieSearchKey;
+  int count;
+};
+
+/**
+ * @brief Command to print command latency and failure statistics
+ */
+class StatsCommand : public Command {
+public:
+  StatsCommand() = default;
+  virtual ~StatsCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+};
+
+/**
+ * @brief Command to close a customer account
+ */
+class CloseCommand : public Command {
+public:
+  CloseCommand() = default;
+  virtual ~CloseCommand() = default;
+
+  bool execute(Store &store) override;
+  char getCommandType() const override;
+  Command *clone() const override;
+  bool setParameters(std::istream &input, const Store &store) override;
+  std::string getDescription() const override;
+
+private:
+  std::string customerID;
+};
+
 #endif // COMMANDS_H
\ No newline at end of file
@@ -0,0 +1,193 @@
+/**
+ * @location header/commandstats.h
+ */
+
+#ifndef COMMANDSTATS_H
+#define COMMANDSTATS_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Log-linear latency histogram in the style of HdrHistogram: values below
+// 64 get a bucket each, and every power of two above that is split into 32
+// buckets, so any recorded value is known to within about 3%. Recording is
+// a count-leading-zeros and an increment.
+class LatencyHistogram {
+public:
+  LatencyHistogram() : counts(BUCKETS, 0), total(0), sum(0), max(0) {}
+
+  void record(uint64_t value) {
+    counts[bucketIndex(value)]++;
+    total++;
+    sum += value;
+    max = std::max(max, value);
+  }
+
+  // Smallest value at or above fraction p of recordings, rounded up to
+  // its bucket's upper edge; 0 when empty
+  uint64_t percentile(double p) const {
+    uint64_t rank = static_cast<uint64_t>(p * total);
+    rank = std::max<uint64_t>(std::min(rank, total), 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::min(bucketUpper(i), max);
+      }
+    }
+    return max;
+  }
+
+  // Add every recording of other, as if recorded here
+  void merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < BUCKETS; i++) {
+      counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    max = std::max(max, other.max);
+  }
+
+  uint64_t getCount() const { return total; }
+  uint64_t getMax() const { return max; }
+  uint64_t getMean() const { return (total > 0) ? sum / total : 0; }
+
+private:
+  static constexpr int SUB_BUCKET_BITS = 6;
+  static constexpr uint64_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static constexpr uint64_t HALF = SUB_BUCKETS / 2;
+  static constexpr size_t BUCKETS =
+      SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * HALF;
+
+  std::vector<uint64_t> counts;
+  uint64_t total;
+  uint64_t sum;
+  uint64_t max;
+
+  // Group g >= 1 holds values whose top set bit is g + 5; its 32 buckets
+  // are the next 5 bits
+  static size_t bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return static_cast<size_t>(value);
+    }
+    int group = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS + 1;
+    uint64_t mantissa = value >> group;
+    return SUB_BUCKETS + (group - 1) * HALF + (mantissa - HALF);
+  }
+
+  static uint64_t bucketUpper(size_t index) {
+    if (index < SUB_BUCKETS) {
+      return index;
+    }
+    size_t group = (index - SUB_BUCKETS) / HALF + 1;
+    uint64_t mantissa = (index - SUB_BUCKETS) % HALF + HALF;
+    return ((mantissa + 1) << group) - 1;
+  }
+};
+
+// Per-command-type latency and outcome counts for the command loop, plus
+// store-wide counters for the usual ways a line fails
+class CommandStats {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  enum Counter {
+    PARSE_FAILURE,
+    UNKNOWN_COMMAND,
+    INVALID_CUSTOMER,
+    INVALID_MOVIE,
+    OUT_OF_STOCK,
+    NUM_COUNTERS
+  };
+
+  CommandStats() : counters{} {}
+
+  void count(Counter counter) { counters[counter]++; }
+  uint64_t getCounter(Counter counter) const { return counters[counter]; }
+
+  // Time taken to parse a line into a command, any type
+  void recordParse(Clock::duration elapsed) {
+    parseLatency.record(toNanos(elapsed));
+  }
+
+  // Time taken by a command's execute, and whether it succeeded
+  void recordExecute(char commandType, Clock::duration elapsed,
+                     bool succeeded) {
+    TypeStats &stats = statsFor(commandType);
+    stats.latency.record(toNanos(elapsed));
+    stats.failures += succeeded ? 0 : 1;
+  }
+
+  // Table of count, failures and latency percentiles per command type,
+  // then the counters
+  void report(std::ostream &out) const {
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+
+    out << "Type      Count   Failed   p50 us   p90 us   p99 us   max us\n";
+    for (size_t type = 0; type < byType.size(); type++) {
+      if (byType[type]) {
+        writeRow(out, std::string(1, static_cast<char>(type)),
+                 byType[type]->latency, byType[type]->failures);
+      }
+    }
+    if (parseLatency.getCount() > 0) {
+      writeRow(out, "parse", parseLatency, counters[PARSE_FAILURE]);
+    }
+
+    out << "Parse failures: " << counters[PARSE_FAILURE] << "\n";
+    out << "Unknown commands: " << counters[UNKNOWN_COMMAND] << "\n";
+    out << "Invalid customers: " << counters[INVALID_CUSTOMER] << "\n";
+    out << "Invalid movies: " << counters[INVALID_MOVIE] << "\n";
+    out << "Out of stock: " << counters[OUT_OF_STOCK] << "\n";
+
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+private:
+  struct TypeStats {
+    LatencyHistogram latency;
+    uint64_t failures = 0;
+  };
+
+  // Indexed by command character; histograms are allocated on first use
+  std::array<std::unique_ptr<TypeStats>, 128> byType;
+  LatencyHistogram parseLatency;
+  std::array<uint64_t, NUM_COUNTERS> counters;
+
+  TypeStats &statsFor(char commandType) {
+    std::unique_ptr<TypeStats> &stats =
+        byType[static_cast<unsigned char>(commandType) % byType.size()];
+    if (!stats) {
+      stats = std::make_unique<TypeStats>();
+    }
+    return *stats;
+  }
+
+  static uint64_t toNanos(Clock::duration elapsed) {
+    auto nanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    return static_cast<uint64_t>(std::max<int64_t>(nanos, 0));
+  }
+
+  static void writeRow(std::ostream &out, const std::string &name,
+                       const LatencyHistogram &latency, uint64_t failures) {
+    out << std::left << std::setw(6) << name << std::right << std::setw(9)
+        << latency.getCount() << std::setw(9) << failures;
+    for (double p : {0.5, 0.9, 0.99}) {
+      out << std::setw(9) << latency.percentile(p) / 1000.0;
+    }
+    out << std::setw(9) << latency.getMax() / 1000.0 << "\n";
+  }
+};
+
+#endif // COMMANDSTATS_H
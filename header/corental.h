@@ -0,0 +1,141 @@
+/**
+ * @location header/corental.h
+ */
+
+#ifndef CORENTAL_H
+#define CORENTAL_H
+
+#include "hashtable.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// "Customers who rented X also rented Y" counts, kept up to date as borrows
+// happen. Each movie keeps at most capacity neighbours using space-saving
+// heavy-hitter counting: an unseen neighbour evicts the lowest one and
+// inherits its count plus one. Any neighbour paired with a movie more than
+// 1/capacity of the time is guaranteed to stay listed, and counts are
+// overestimated by at most the evicted minimum. Memory is bounded by
+// movies * capacity, and a borrow costs O(window * capacity).
+class CoRentalIndex {
+public:
+  // How many of a customer's most recent distinct borrows are paired with
+  // each new one
+  static constexpr size_t WINDOW = 8;
+
+  struct Neighbour {
+    uint32_t movieIndex; // Catalog index
+    uint32_t count;
+  };
+
+  explicit CoRentalIndex(size_t capacity = 64)
+      : capacity(capacity), pairUpdates(0) {}
+
+  // Pair a customer's borrow of movieIndex with their recent borrows. A
+  // movie still in the customer's window is not paired again.
+  void recordBorrow(uint64_t customerID, uint32_t movieIndex) {
+    RecentBorrows *recent = windows.find(customerID);
+    if (recent == nullptr) {
+      windows.insert(customerID, RecentBorrows());
+      recent = windows.find(customerID);
+    }
+
+    size_t held = std::min<size_t>(recent->total, WINDOW);
+    for (size_t i = 0; i < held; i++) {
+      if (recent->movies[i] == movieIndex) {
+        return;
+      }
+    }
+
+    for (size_t i = 0; i < held; i++) {
+      bump(movieIndex, recent->movies[i]);
+      bump(recent->movies[i], movieIndex);
+    }
+    recent->movies[recent->total % WINDOW] = movieIndex;
+    recent->total++;
+  }
+
+  // Up to n neighbours of movieIndex, most co-rented first, in O(n)
+  std::vector<Neighbour> neighbours(uint32_t movieIndex, size_t n) const {
+    if (movieIndex >= lists.size()) {
+      return {};
+    }
+    const std::vector<Neighbour> &list = lists[movieIndex];
+    size_t count = std::min(n, list.size());
+    return std::vector<Neighbour>(list.begin(), list.begin() + count);
+  }
+
+  // Forget a retired movie's own neighbours; other lists that name it are
+  // filtered by the caller and age out as new pairs arrive
+  void remove(uint32_t movieIndex) {
+    if (movieIndex < lists.size()) {
+      std::vector<Neighbour>().swap(lists[movieIndex]);
+    }
+  }
+
+  size_t getCapacity() const { return capacity; }
+
+  // Neighbour counters changed so far, two per pair
+  uint64_t getPairUpdates() const { return pairUpdates; }
+
+  size_t memoryUsage() const {
+    size_t bytes = lists.capacity() * sizeof(std::vector<Neighbour>);
+    for (const std::vector<Neighbour> &list : lists) {
+      bytes += list.capacity() * sizeof(Neighbour);
+    }
+    // Chained table node: key, window and two list pointers
+    bytes += windows.size() *
+             (sizeof(uint64_t) + sizeof(RecentBorrows) + 2 * sizeof(void *));
+    return bytes;
+  }
+
+private:
+  // Ring of a customer's last WINDOW distinct borrows
+  struct RecentBorrows {
+    std::array<uint32_t, WINDOW> movies{};
+    uint32_t total = 0; // Borrows recorded; the ring holds the last WINDOW
+  };
+
+  size_t capacity;
+  uint64_t pairUpdates;
+  // Neighbours by catalog index, each sorted by count, highest first
+  std::vector<std::vector<Neighbour>> lists;
+  HashTable<uint64_t, RecentBorrows> windows;
+
+  // Count one co-rental of other with movieIndex
+  void bump(uint32_t movieIndex, uint32_t other) {
+    if (movieIndex >= lists.size()) {
+      lists.resize(movieIndex + 1);
+    }
+    std::vector<Neighbour> &list = lists[movieIndex];
+    pairUpdates++;
+
+    auto it = std::find_if(
+        list.begin(), list.end(),
+        [other](const Neighbour &entry) { return entry.movieIndex == other; });
+    if (it != list.end()) {
+      it->count++;
+    } else if (list.size() < capacity) {
+      if (list.empty()) {
+        list.reserve(capacity);
+      }
+      list.push_back({other, 1});
+      it = list.end() - 1;
+    } else if (capacity > 0) {
+      // Space-saving: replace the smallest counter
+      list.back() = {other, list.back().count + 1};
+      it = list.end() - 1;
+    } else {
+      return;
+    }
+
+    // Bubble up to restore descending order
+    while (it != list.begin() && (it - 1)->count < it->count) {
+      std::iter_swap(it - 1, it);
+      --it;
+    }
+  }
+};
+
+#endif // CORENTAL_H
@@ -5,87 +5,156 @@
 #ifndef CUSTOMER_H
 #define CUSTOMER_H
 
+#include "encoder.h"
+#include "formatbuffer.h"
 #include "movie.h"
+#include "transactionlog.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-// Single transaction record
-class Transaction {
+// Customer in the movie store system
+class Customer {
 public:
-  enum Type { BORROW, RETURN };
+  // Standard IDs are exactly this many digits
+  static constexpr size_t ID_DIGITS = 4;
 
-  Transaction(Type type, const Movie *movie)
-      : transactionType(type), moviePtr(movie) {}
+  // Wide IDs are up to this many digits, always fitting in 64 bits
+  static constexpr size_t MAX_WIDE_ID_DIGITS = 19;
 
-  // Simple display for sample output compliance
-  void display(std::ostream &out) const {
-    out << (transactionType == BORROW ? "Borrow " : "Return ");
-    out << moviePtr->getTitle();
+  // id is written with idDigits digits, zero-padded
+  Customer(uint64_t id, size_t idDigits, const std::string &lastName,
+           const std::string &firstName)
+      : customerID(id), idDigits(static_cast<uint8_t>(idDigits)),
+        lastName(lastName), firstName(firstName), log(nullptr), history(0) {}
+
+  // Keep history in the store's shared log; transactions are only
+  // recorded once attached
+  void attachLog(TransactionLog *transactionLog) {
+    log = transactionLog;
+    history = log->addHistory();
   }
 
-  // Detailed display showing full movie information
-  void displayDetailed(std::ostream &out) const {
-    out << (transactionType == BORROW ? "Borrow " : "Return ");
-    out << moviePtr->getTitle() << " ";
-    moviePtr->display(out);
+  // ID as written in the data file
+  std::string getID() const {
+    std::string digits = std::to_string(customerID);
+    if (digits.size() < idDigits) {
+      digits.insert(0, idDigits - digits.size(), '0');
+    }
+    return digits;
   }
 
-  Type getType() const { return transactionType; }
-  const Movie *getMovie() const { return moviePtr; }
-
-private:
-  Type transactionType;
-  const Movie *moviePtr; // Non-owning pointer
-};
-
-// Customer in the movie store system
-class Customer {
-public:
-  Customer(const std::string &id, const std::string &lastName,
-           const std::string &firstName)
-      : customerID(id), lastName(lastName), firstName(firstName) {}
-
-  const std::string &getID() const { return customerID; }
+  uint64_t getNumericID() const { return customerID; }
   std::string getFullName() const { return firstName + " " + lastName; }
   std::string getDisplayName() const { return lastName + " " + firstName; }
 
+  // True once any transaction has been recorded
+  bool hasHistory() const { return log != nullptr && !log->empty(history); }
+
   void addTransaction(Transaction::Type type, const Movie *movie) {
-    transactions.emplace_back(type, movie);
+    if (log != nullptr) {
+      log->append(history, type, movie);
+    }
   }
 
   // Standard history display matching sample output format
   void displayHistory(std::ostream &out) const {
-    out << "History for " << customerID << " " << getDisplayName() << ":\n";
+    FormatBuffer buffer;
+    formatHistory(buffer, false);
+    buffer.flushTo(out);
+  }
+
+  // Comprehensive history display with full movie details
+  void displayDetailedHistory(std::ostream &out) const {
+    FormatBuffer buffer;
+    formatHistory(buffer, true);
+    buffer.flushTo(out);
+  }
 
-    if (transactions.empty()) {
-      out << "No history for " << getDisplayName() << "\n";
+  // Format history into out, with full movie details if detailed
+  void formatHistory(FormatBuffer &out, bool detailed) const {
+    if (!formatHistoryHeader(out)) {
       return;
     }
 
-    for (const auto &transaction : transactions) {
-      transaction.display(out);
-      out << " " << getDisplayName() << " ";
-      out << transaction.getMovie()->getTitle() << "\n";
+    const std::string displayName = getDisplayName();
+    log->forEach(history, [&](const Transaction &transaction) {
+      transaction.format(out);
+      out << " " << displayName << " ";
+      if (detailed) {
+        transaction.formatDetailed(out);
+      } else {
+        out << transaction.getMovie()->getTitle();
+      }
+      out << '\n';
+    });
+  }
+
+  // Lines formatHistory starts with; false if no transactions follow
+  bool formatHistoryHeader(FormatBuffer &out) const {
+    const std::string displayName = getDisplayName();
+    out << "History for " << getID() << " " << displayName << ":\n";
+    if (!hasHistory()) {
+      out << "No history for " << displayName << "\n";
+      return false;
     }
+    return true;
   }
 
-  // Comprehensive history display with full movie details
-  void displayDetailedHistory(std::ostream &out) const {
-    out << "History for " << customerID << " " << getDisplayName() << ":\n";
+  // Cursor over the transactions so far, for the *HistoryFrom methods to
+  // render a slice at a time; only for a customer with history
+  TransactionLog::Cursor historyCursor() const { return log->cursor(history); }
+
+  // Format up to limit transactions from cursor on, as formatHistory does
+  // after its header; true once the cursor is done
+  bool formatHistoryFrom(TransactionLog::Cursor &cursor, size_t limit,
+                         FormatBuffer &out) const {
+    const std::string displayName = getDisplayName();
+    return log->forEachFrom(cursor, limit, [&](const Transaction &transaction) {
+      transaction.format(out);
+      out << " " << displayName << " " << transaction.getMovie()->getTitle()
+          << '\n';
+    });
+  }
+
+  // Encode up to limit transactions from cursor on, as encodeHistory does
+  bool encodeHistoryFrom(TransactionLog::Cursor &cursor, size_t limit,
+                         OutputEncoder &encoder, FormatBuffer &out) const {
+    const std::string id = getID();
+    return log->forEachFrom(cursor, limit, [&](const Transaction &transaction) {
+      encoder.encodeTransaction(id, transaction, out);
+    });
+  }
 
-    if (transactions.empty()) {
-      out << "No history for " << getDisplayName() << "\n";
+  // Encode each transaction as one record
+  void encodeHistory(OutputEncoder &encoder, FormatBuffer &out) const {
+    if (!hasHistory()) {
       return;
     }
 
-    for (const auto &transaction : transactions) {
-      transaction.display(out);
-      out << " " << getDisplayName() << " ";
-      transaction.displayDetailed(out);
-      out << "\n";
+    const std::string id = getID();
+    log->forEach(history, [&](const Transaction &transaction) {
+      encoder.encodeTransaction(id, transaction, out);
+    });
+  }
+
+  // True if any movie borrowed has not been returned
+  bool hasOutstandingRentals() const {
+    if (!hasHistory()) {
+      return false;
     }
+
+    std::unordered_map<const Movie *, int> outstanding;
+    log->forEach(history, [&](const Transaction &transaction) {
+      outstanding[transaction.getMovie()] +=
+          (transaction.getType() == Transaction::BORROW) ? 1 : -1;
+    });
+    return std::any_of(outstanding.begin(), outstanding.end(),
+                       [](const auto &entry) { return entry.second > 0; });
   }
 
   // Check if customer currently has this movie borrowed
@@ -93,7 +162,11 @@ public:
     int borrowCount = 0;
     int returnCount = 0;
 
-    for (const auto &transaction : transactions) {
+    if (!hasHistory()) {
+      return false;
+    }
+
+    log->forEach(history, [&](const Transaction &transaction) {
       if (transaction.getMovie() == movie) {
         if (transaction.getType() == Transaction::BORROW) {
           borrowCount++;
@@ -101,13 +174,14 @@ public:
           returnCount++;
         }
       }
-    }
+    });
 
     return borrowCount > returnCount;
   }
 
-  // Parse from input: ID LastName FirstName
-  static std::unique_ptr<Customer> parseFromStream(std::istream &input) {
+  // Parse from input: ID LastName FirstName, allowing wide IDs if asked
+  static std::unique_ptr<Customer> parseFromStream(std::istream &input,
+                                                   bool wideIDs = false) {
     std::string id;
     std::string lastName;
     std::string firstName;
@@ -116,24 +190,42 @@ public:
       return nullptr;
     }
 
-    // Validate 4-digit ID
-    if (id.length() != 4) {
+    uint64_t numericID = 0;
+    if (!parseID(id, wideIDs, numericID)) {
       return nullptr;
     }
+
+    return std::make_unique<Customer>(numericID, id.length(), lastName,
+                                      firstName);
+  }
+
+  // Validate and convert an ID: exactly 4 digits, or 1 to 19 if wide.
+  // Wide IDs are stored as numbers, so they may not have leading zeros,
+  // which would make "0123" and "123" the same customer.
+  static bool parseID(const std::string &id, bool wideIDs, uint64_t &value) {
+    if (wideIDs ? (id.empty() || id.length() > MAX_WIDE_ID_DIGITS ||
+                   (id.length() > 1 && id[0] == '0'))
+                : id.length() != ID_DIGITS) {
+      return false;
+    }
+
+    value = 0;
     for (char c : id) {
-      if (std::isdigit(c) == 0) {
-        return nullptr;
+      if (std::isdigit(static_cast<unsigned char>(c)) == 0) {
+        return false;
       }
+      value = value * 10 + static_cast<uint64_t>(c - '0');
     }
-
-    return std::make_unique<Customer>(id, lastName, firstName);
+    return true;
   }
 
 private:
-  std::string customerID;
+  uint64_t customerID;
+  uint8_t idDigits; // Width the ID was written with, for leading zeros
   std::string lastName;
   std::string firstName;
-  std::vector<Transaction> transactions; // Chronological order
+  TransactionLog *log; // Shared with the store's other customers
+  uint32_t history;    // Handle of this customer's history in log
 };
 
 #endif // CUSTOMER_H
\ No newline at end of file
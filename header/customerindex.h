@@ -0,0 +1,129 @@
+/**
+ * @location header/customerindex.h
+ */
+
+#ifndef CUSTOMERINDEX_H
+#define CUSTOMERINDEX_H
+
+#include <cstdint>
+#include <vector>
+
+class Customer;
+
+// Open-addressing map from numeric customer ID to customer. Slots are
+// 16 bytes in one flat array and collisions probe linearly, so a lookup
+// touches one or two cache lines.
+class CustomerIndex {
+public:
+  CustomerIndex() : numEntries(0) { slots.resize(MIN_CAPACITY); }
+
+  // Make room for count entries without rehashing
+  void reserve(size_t count) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity * MAX_LOAD_NUM < count * MAX_LOAD_DEN) {
+      capacity *= 2;
+    }
+    if (capacity > slots.size()) {
+      rehash(capacity);
+    }
+  }
+
+  // Add id, false if it is already present
+  bool insert(uint64_t id, Customer *customer) {
+    if ((numEntries + 1) * MAX_LOAD_DEN > slots.size() * MAX_LOAD_NUM) {
+      rehash(slots.size() * 2);
+    }
+
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash(id) & mask;; i = (i + 1) & mask) {
+      if (slots[i].customer == nullptr) {
+        slots[i] = {id, customer};
+        numEntries++;
+        return true;
+      }
+      if (slots[i].id == id) {
+        return false;
+      }
+    }
+  }
+
+  // Customer with id, nullptr if none
+  Customer *find(uint64_t id) const {
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash(id) & mask;; i = (i + 1) & mask) {
+      if (slots[i].customer == nullptr || slots[i].id == id) {
+        return slots[i].customer;
+      }
+    }
+  }
+
+  // Remove id, false if absent. Later entries of the probe run shift back
+  // into the gap, so lookups never need tombstones.
+  bool erase(uint64_t id) {
+    size_t mask = slots.size() - 1;
+    size_t gap = hash(id) & mask;
+    while (slots[gap].id != id || slots[gap].customer == nullptr) {
+      if (slots[gap].customer == nullptr) {
+        return false;
+      }
+      gap = (gap + 1) & mask;
+    }
+
+    for (size_t i = (gap + 1) & mask; slots[i].customer != nullptr;
+         i = (i + 1) & mask) {
+      // An entry may fill the gap only if its home slot is not in (gap, i]
+      size_t home = hash(slots[i].id) & mask;
+      if (((i - home) & mask) >= ((i - gap) & mask)) {
+        slots[gap] = slots[i];
+        gap = i;
+      }
+    }
+    slots[gap] = Slot();
+    numEntries--;
+    return true;
+  }
+
+  size_t size() const { return numEntries; }
+  size_t memoryUsage() const { return slots.capacity() * sizeof(Slot); }
+
+private:
+  // Keep at most 7 of every 10 slots full
+  static constexpr size_t MAX_LOAD_NUM = 7;
+  static constexpr size_t MAX_LOAD_DEN = 10;
+  static constexpr size_t MIN_CAPACITY = 16;
+
+  // Empty slots have a null customer
+  struct Slot {
+    uint64_t id = 0;
+    Customer *customer = nullptr;
+  };
+
+  std::vector<Slot> slots; // Capacity is a power of two
+  size_t numEntries;
+
+  // Mix bits so runs of sequential IDs spread across the table
+  static size_t hash(uint64_t id) {
+    id ^= id >> 33;
+    id *= 0xFF51AFD7ED558CCDULL;
+    id ^= id >> 33;
+    return static_cast<size_t>(id);
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<Slot> old(capacity);
+    old.swap(slots);
+    size_t mask = capacity - 1;
+    for (const Slot &slot : old) {
+      if (slot.customer == nullptr) {
+        continue;
+      }
+      size_t i = hash(slot.id) & mask;
+      while (slots[i].customer != nullptr) {
+        i = (i + 1) & mask;
+      }
+      slots[i] = slot;
+    }
+  }
+};
+
+#endif // CUSTOMERINDEX_H
@@ -0,0 +1,38 @@
+/**
+ * @location header/deltawatcher.h
+ */
+
+#ifndef DELTAWATCHER_H
+#define DELTAWATCHER_H
+
+#include <string>
+#include <vector>
+
+// Watches a directory for delta files finished being written (or moved
+// in), using inotify where available. Polling never blocks, so the store
+// can check for deltas between commands.
+class DeltaWatcher {
+public:
+  DeltaWatcher();
+  ~DeltaWatcher();
+
+  // No copying: owns a file descriptor
+  DeltaWatcher(const DeltaWatcher &) = delete;
+  DeltaWatcher &operator=(const DeltaWatcher &) = delete;
+
+  // Start watching directory, false if it cannot be watched
+  bool watch(const std::string &directory);
+
+  // Paths of files that arrived since the last poll, in arrival order
+  std::vector<std::string> poll();
+
+  // Directory being watched, empty if none
+  const std::string &getDirectory() const { return watchedDirectory; }
+
+private:
+  int inotifyFd;
+  int watchDescriptor;
+  std::string watchedDirectory;
+};
+
+#endif // DELTAWATCHER_H
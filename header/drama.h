@@ -7,13 +7,13 @@
 
 #include "movie.h"
 
-class Drama : public Movie {
+class Drama final : public Movie {
 public:
   Drama();
   virtual ~Drama() = default;
 
   // Display for inventory: Director, Title, Year (Stock) - Drama
-  void display(std::ostream &out) const override;
+  void format(FormatBuffer &out) const override;
 
   // Sort key: "Director Title"
   std::string getSortingKey() const override;
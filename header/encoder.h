@@ -0,0 +1,51 @@
+/**
+ * @location header/encoder.h
+ */
+
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include "formatbuffer.h"
+#include "movie.h"
+#include "transactionlog.h"
+#include <memory>
+#include <string>
+
+// How Inventory and History output is written. DEFAULT defers to the
+// store-wide setting; TEXT is the human-readable report.
+enum class OutputFormat { DEFAULT, TEXT, JSON_LINES, CSV, BINARY };
+
+// Parse "text", "json", "csv" or "binary"; false if name is none of these
+bool parseOutputFormat(const std::string &name, OutputFormat &format);
+
+// Writes inventory and history rows in a machine-readable format, one
+// record per call, straight from the movies and transactions. A record
+// with a field the format cannot hold is left out and counted rather than
+// written truncated.
+class OutputEncoder {
+public:
+  virtual ~OutputEncoder() = default;
+
+  // Emit anything that precedes inventory rows (e.g. a CSV header)
+  virtual void beginInventory(FormatBuffer &out) { (void)out; }
+
+  // Emit anything that precedes history rows
+  virtual void beginHistory(FormatBuffer &out) { (void)out; }
+
+  virtual void encodeMovie(const Movie &movie, FormatBuffer &out) = 0;
+
+  virtual void encodeTransaction(const std::string &customerID,
+                                 const Transaction &transaction,
+                                 FormatBuffer &out) = 0;
+
+  // Records left out so far because a field did not fit the format
+  size_t getSkipped() const { return skipped; }
+
+  // Encoder for format, nullptr for TEXT and DEFAULT
+  static std::unique_ptr<OutputEncoder> create(OutputFormat format);
+
+protected:
+  size_t skipped = 0;
+};
+
+#endif // ENCODER_H
@@ -6,16 +6,35 @@
 #define FACTORY_H
 
 #include "command.h"
+#include "flatstore.h"
 #include "movie.h"
+#include <bitset>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <unordered_map>
 
+// Type codes switched off for one store, so stores in the same process can
+// run with different subsets of the registered types. A masked code is
+// treated as if its registrar were not linked in.
+class TypeMask {
+public:
+  void disable(char typeCode) { disabled.set(index(typeCode)); }
+  bool allows(char typeCode) const { return !disabled.test(index(typeCode)); }
+
+private:
+  std::bitset<256> disabled;
+
+  static size_t index(char typeCode) {
+    return static_cast<unsigned char>(typeCode);
+  }
+};
+
 // Factory for creating Movie objects based on genre code
 class MovieFactory {
 public:
   using MovieCreator = std::function<std::unique_ptr<Movie>()>;
+  using GenreStoreCreator = std::function<std::unique_ptr<GenreStore>()>;
 
   // Singleton instance
   static MovieFactory &getInstance() {
@@ -33,17 +52,40 @@ public:
     return true;
   }
 
-  // Create movie by type code
-  std::unique_ptr<Movie> createMovie(char movieType) const {
+  // Create movie by type code, nullptr if unregistered or masked
+  std::unique_ptr<Movie> createMovie(char movieType,
+                                     const TypeMask &mask = TypeMask()) const {
     auto it = creators.find(movieType);
-    if (it != creators.end()) {
+    if (it != creators.end() && mask.allows(movieType)) {
       return it->second();
     }
     return nullptr;
   }
 
-  bool isValidMovieType(char movieType) const {
-    return creators.find(movieType) != creators.end();
+  bool isValidMovieType(char movieType,
+                        const TypeMask &mask = TypeMask()) const {
+    return creators.find(movieType) != creators.end() &&
+           mask.allows(movieType);
+  }
+
+  // Register contiguous storage for a movie type's flat storage mode
+  bool registerGenreStore(char movieType, GenreStoreCreator creator) {
+    if (storeCreators.find(movieType) != storeCreators.end()) {
+      std::cerr << "Genre store " << movieType << " already registered\n";
+      return false;
+    }
+    storeCreators[movieType] = creator;
+    return true;
+  }
+
+  // Create genre storage by type code, nullptr if not registered or masked
+  std::unique_ptr<GenreStore>
+  createGenreStore(char movieType, const TypeMask &mask = TypeMask()) const {
+    auto it = storeCreators.find(movieType);
+    if (it != storeCreators.end() && mask.allows(movieType)) {
+      return it->second();
+    }
+    return nullptr;
   }
 
 private:
@@ -52,6 +94,7 @@ private:
   MovieFactory &operator=(const MovieFactory &) = delete;
 
   std::unordered_map<char, MovieCreator> creators;
+  std::unordered_map<char, GenreStoreCreator> storeCreators;
 };
 
 // Factory for creating Command objects based on command code
@@ -75,17 +118,20 @@ public:
     return true;
   }
 
-  // Create command by type code
-  std::unique_ptr<Command> createCommand(char commandType) const {
+  // Create command by type code, nullptr if unregistered or masked
+  std::unique_ptr<Command>
+  createCommand(char commandType, const TypeMask &mask = TypeMask()) const {
     auto it = creators.find(commandType);
-    if (it != creators.end()) {
+    if (it != creators.end() && mask.allows(commandType)) {
       return it->second();
     }
     return nullptr;
   }
 
-  bool isValidCommandType(char commandType) const {
-    return creators.find(commandType) != creators.end();
+  bool isValidCommandType(char commandType,
+                          const TypeMask &mask = TypeMask()) const {
+    return creators.find(commandType) != creators.end() &&
+           mask.allows(commandType);
   }
 
 private:
@@ -0,0 +1,160 @@
+/**
+ * @location header/flatstore.h
+ */
+
+#ifndef FLATSTORE_H
+#define FLATSTORE_H
+
+#include "formatbuffer.h"
+#include "hashtable.h"
+#include "movie.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One genre's movies, with one virtual call per operation instead of one
+// per movie visited
+class GenreStore {
+public:
+  virtual ~GenreStore() = default;
+
+  // Take over a parsed movie of this genre, returning its stable address
+  virtual Movie *add(std::unique_ptr<Movie> movie) = 0;
+
+  // Make key find movie
+  virtual void addSearchKey(const std::string &key, Movie *movie) = 0;
+
+  // Stop listing and finding movie; its record stays allocated so
+  // pointers to it remain valid
+  virtual void remove(Movie *movie) = 0;
+
+  // Movie with search key, nullptr if none
+  virtual Movie *find(const std::string &key) const = 0;
+
+  // Display every movie in sorting key order, one per line
+  virtual void display(std::ostream &out) const = 0;
+
+  // Visit every movie in sorting key order
+  virtual void
+  forEachSorted(const std::function<void(const Movie *)> &visit) const = 0;
+
+  // Visit every movie, in no particular order
+  virtual void forEach(const std::function<void(Movie *)> &visit) const = 0;
+
+  virtual size_t size() const = 0;
+};
+
+// Concrete records of genre T in contiguous fixed-capacity chunks. Chunks
+// never reallocate, so addresses stay valid as the genre grows. T should be
+// final so calls on records are resolved at compile time.
+template <typename T> class FlatGenreStore : public GenreStore {
+public:
+  FlatGenreStore() : numRecords(0), sorted(true) {}
+
+  Movie *add(std::unique_ptr<Movie> movie) override {
+    if (chunks.empty() || chunks.back().size() == CHUNK_SIZE) {
+      chunks.emplace_back();
+      chunks.back().reserve(CHUNK_SIZE);
+    }
+
+    chunks.back().push_back(static_cast<const T &>(*movie));
+    T *record = &chunks.back().back();
+    order.push_back(record);
+    numRecords++;
+    sorted = false;
+    return record;
+  }
+
+  void addSearchKey(const std::string &key, Movie *movie) override {
+    keys.insert(key, static_cast<T *>(movie));
+  }
+
+  void remove(Movie *movie) override {
+    for (const std::string &key : movie->getSearchKeys()) {
+      T **record = keys.find(key);
+      if (record != nullptr && *record == movie) {
+        keys.erase(key);
+      }
+    }
+
+    // Tombstoned here and dropped from the order by the next listing, so
+    // retiring many titles costs one pass over the order, not one each
+    if (removed.insert(static_cast<T *>(movie), true)) {
+      numRecords--;
+    }
+  }
+
+  Movie *find(const std::string &key) const override {
+    T *const *record = keys.find(key);
+    return (record != nullptr) ? *record : nullptr;
+  }
+
+  void display(std::ostream &out) const override {
+    sortIfNeeded();
+    FormatBuffer buffer;
+    for (const T *record : order) {
+      record->format(buffer);
+      buffer << '\n';
+      buffer.flushIfFull(out);
+    }
+    buffer.flushTo(out);
+  }
+
+  void forEachSorted(
+      const std::function<void(const Movie *)> &visit) const override {
+    sortIfNeeded();
+    for (const T *record : order) {
+      visit(record);
+    }
+  }
+
+  void forEach(const std::function<void(Movie *)> &visit) const override {
+    dropRemoved();
+    for (T *record : order) {
+      visit(record);
+    }
+  }
+
+  size_t size() const override { return numRecords; }
+
+private:
+  static constexpr size_t CHUNK_SIZE = 256;
+
+  std::vector<std::vector<T>> chunks;
+  HashTable<std::string, T *> keys;
+  size_t numRecords;
+
+  // Records in sorting key order, re-sorted lazily after additions
+  mutable std::vector<T *> order;
+  mutable bool sorted;
+
+  // Removed records still in order
+  mutable HashTable<const T *, bool> removed;
+
+  void dropRemoved() const {
+    if (removed.empty()) {
+      return;
+    }
+    order.erase(std::remove_if(order.begin(), order.end(),
+                               [this](const T *record) {
+                                 return removed.contains(record);
+                               }),
+                order.end());
+    removed = HashTable<const T *, bool>();
+  }
+
+  // Stable sort keeps equal keys in insertion order, as the BST does
+  void sortIfNeeded() const {
+    dropRemoved();
+    if (!sorted) {
+      std::stable_sort(order.begin(), order.end(),
+                       [](const T *a, const T *b) { return *a < *b; });
+      sorted = true;
+    }
+  }
+};
+
+#endif // FLATSTORE_H
@@ -0,0 +1,126 @@
+/**
+ * @location header/formatbuffer.h
+ */
+
+#ifndef FORMATBUFFER_H
+#define FORMATBUFFER_H
+
+#include "stringpool.h"
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Growable char buffer for building output text without going through
+// iostream formatting; integers use std::to_chars, strings are copied
+// with memcpy. The text matches what operator<< on a default-formatted
+// std::ostream would produce.
+class FormatBuffer {
+public:
+  // Buffers are flushed to their stream once they hold this much text
+  static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+  FormatBuffer()
+      : buffer(new char[INITIAL_CAPACITY]), length(0),
+        bufferCapacity(INITIAL_CAPACITY) {}
+
+  // No copying
+  FormatBuffer(const FormatBuffer &) = delete;
+  FormatBuffer &operator=(const FormatBuffer &) = delete;
+
+  FormatBuffer &append(const char *text, size_t count) {
+    reserveExtra(count);
+    std::memcpy(buffer.get() + length, text, count);
+    length += count;
+    return *this;
+  }
+
+  FormatBuffer &operator<<(const std::string &text) {
+    return append(text.data(), text.size());
+  }
+
+  FormatBuffer &operator<<(const InternedString &text) {
+    return *this << text.str();
+  }
+
+  FormatBuffer &operator<<(const char *text) {
+    return append(text, std::strlen(text));
+  }
+
+  FormatBuffer &operator<<(char c) {
+    reserveExtra(1);
+    buffer[length++] = c;
+    return *this;
+  }
+
+  FormatBuffer &operator<<(int value) { return appendInteger(value); }
+  FormatBuffer &operator<<(long value) { return appendInteger(value); }
+  FormatBuffer &operator<<(long long value) { return appendInteger(value); }
+  FormatBuffer &operator<<(unsigned value) { return appendInteger(value); }
+  FormatBuffer &operator<<(unsigned long value) {
+    return appendInteger(value);
+  }
+  FormatBuffer &operator<<(unsigned long long value) {
+    return appendInteger(value);
+  }
+
+  // Overwrite bytes already in the buffer, e.g. to fill in a length prefix
+  void patch(size_t offset, const char *bytes, size_t count) {
+    std::memcpy(buffer.get() + offset, bytes, count);
+  }
+
+  // Write the buffered text to out and empty the buffer
+  void flushTo(std::ostream &out) {
+    out.write(buffer.get(), static_cast<std::streamsize>(length));
+    length = 0;
+  }
+
+  // Flush only once enough text has built up to be worth a write
+  void flushIfFull(std::ostream &out) {
+    if (length >= FLUSH_THRESHOLD) {
+      flushTo(out);
+    }
+  }
+
+  const char *data() const { return buffer.get(); }
+  size_t size() const { return length; }
+  bool empty() const { return length == 0; }
+  void clear() { length = 0; }
+  std::string str() const { return std::string(buffer.get(), length); }
+
+private:
+  static constexpr size_t INITIAL_CAPACITY = 256;
+
+  // Longest decimal integer, with sign
+  static constexpr size_t MAX_INTEGER_DIGITS = 24;
+
+  std::unique_ptr<char[]> buffer;
+  size_t length;
+  size_t bufferCapacity;
+
+  template <typename Integer> FormatBuffer &appendInteger(Integer value) {
+    reserveExtra(MAX_INTEGER_DIGITS);
+    char *start = buffer.get() + length;
+    auto result = std::to_chars(start, start + MAX_INTEGER_DIGITS, value);
+    length += result.ptr - start;
+    return *this;
+  }
+
+  void reserveExtra(size_t count) {
+    if (length + count <= bufferCapacity) {
+      return;
+    }
+
+    size_t newCapacity = bufferCapacity * 2;
+    while (newCapacity < length + count) {
+      newCapacity *= 2;
+    }
+    std::unique_ptr<char[]> larger(new char[newCapacity]);
+    std::memcpy(larger.get(), buffer.get(), length);
+    buffer = std::move(larger);
+    bufferCapacity = newCapacity;
+  }
+};
+
+#endif // FORMATBUFFER_H
@@ -87,8 +87,31 @@ public:
     return nullptr;
   }
 
+  // Remove key and its value, returns false if key is absent. Chains
+  // simply unlink the entry, so no tombstones are left behind.
+  bool erase(const K &key) {
+    Bucket &bucket = table[hash(key)];
+    for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+      if (it->first == key) {
+        bucket.erase(it);
+        numElements--;
+        return true;
+      }
+    }
+    return false;
+  }
+
   bool contains(const K &key) const { return find(key) != nullptr; }
 
+  // Visit every key and value, in no particular order
+  void forEach(const std::function<void(const K &, const V &)> &visit) const {
+    for (const auto &bucket : table) {
+      for (const auto &pair : bucket) {
+        visit(pair.first, pair.second);
+      }
+    }
+  }
+
   size_t size() const { return numElements; }
   bool empty() const { return numElements == 0; }
   double loadFactor() const {
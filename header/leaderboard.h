@@ -0,0 +1,180 @@
+/**
+ * @location header/leaderboard.h
+ */
+
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include "hashtable.h"
+#include "movie.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Count-Min Sketch for memory-bounded approximate counts
+class CountMinSketch {
+public:
+  CountMinSketch(size_t width, size_t depth)
+      : width(std::max<size_t>(width, 1)), depth(std::max<size_t>(depth, 1)),
+        counters(this->width * this->depth, 0) {}
+
+  // Increment key and return its new estimated count
+  uint32_t increment(const void *key) {
+    uint32_t estimate = UINT32_MAX;
+    for (size_t row = 0; row < depth; row++) {
+      uint32_t &counter = counters[row * width + slot(key, row)];
+      counter++;
+      estimate = std::min(estimate, counter);
+    }
+    return estimate;
+  }
+
+  // Estimated count, never lower than the true count
+  uint32_t estimate(const void *key) const {
+    uint32_t result = UINT32_MAX;
+    for (size_t row = 0; row < depth; row++) {
+      result = std::min(result, counters[row * width + slot(key, row)]);
+    }
+    return result;
+  }
+
+  size_t memoryUsage() const { return counters.size() * sizeof(uint32_t); }
+
+private:
+  size_t width;
+  size_t depth;
+  std::vector<uint32_t> counters; // depth rows of width counters
+
+  // Independent hash per row (splitmix64 finalizer over key and row)
+  size_t slot(const void *key, size_t row) const {
+    uint64_t h = reinterpret_cast<uintptr_t>(key) +
+                 (row + 1) * 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h % width;
+  }
+};
+
+// Borrow counts for one genre, with the most borrowed titles kept sorted
+class Leaderboard {
+public:
+  struct Entry {
+    const Movie *movie;
+    uint32_t count;
+  };
+
+  explicit Leaderboard(size_t capacity = 10) : capacity(capacity) {}
+
+  // Switch to approximate counting, call before any borrow is recorded
+  void useSketch(size_t width, size_t depth) {
+    sketch = std::make_unique<CountMinSketch>(width, depth);
+  }
+
+  // Bump the movie's counter and update the top entries
+  uint32_t recordBorrow(const Movie *movie) {
+    uint32_t count = 0;
+    if (sketch) {
+      count = sketch->increment(movie);
+    } else {
+      uint32_t *counter = counts.find(movie);
+      if (counter == nullptr) {
+        counts.insert(movie, 1);
+        count = 1;
+      } else {
+        count = ++(*counter);
+      }
+    }
+    updateTop(movie, count);
+    return count;
+  }
+
+  // Borrow count for movie (an upper bound in sketch mode)
+  uint32_t getCount(const Movie *movie) const {
+    if (sketch) {
+      return sketch->estimate(movie);
+    }
+    const uint32_t *counter = counts.find(movie);
+    return (counter != nullptr) ? *counter : 0;
+  }
+
+  // Drop a retired title. Exact counts refill its slot from the highest
+  // remaining count, in one pass over the titles; a sketch cannot list
+  // its titles, so there the slot refills only from later borrows.
+  void remove(const Movie *movie) {
+    counts.erase(movie);
+    auto it = std::find_if(
+        topEntries.begin(), topEntries.end(),
+        [movie](const Entry &entry) { return entry.movie == movie; });
+    if (it == topEntries.end()) {
+      return;
+    }
+    topEntries.erase(it);
+    if (!sketch) {
+      refillTop();
+    }
+  }
+
+  // Up to n most borrowed titles, highest count first
+  std::vector<Entry> top(size_t n) const {
+    size_t count = std::min(n, topEntries.size());
+    return std::vector<Entry>(topEntries.begin(), topEntries.begin() + count);
+  }
+
+  // Most titles top can return
+  size_t getCapacity() const { return capacity; }
+
+private:
+  size_t capacity;
+  std::vector<Entry> topEntries; // Sorted by count, highest first
+  HashTable<const Movie *, uint32_t> counts;
+  std::unique_ptr<CountMinSketch> sketch;
+
+  // Counts only grow, so a title outside the top entries can enter only by
+  // passing the current minimum
+  void updateTop(const Movie *movie, uint32_t count) {
+    auto it = std::find_if(
+        topEntries.begin(), topEntries.end(),
+        [movie](const Entry &entry) { return entry.movie == movie; });
+
+    if (it != topEntries.end()) {
+      it->count = count;
+    } else if (topEntries.size() < capacity) {
+      topEntries.push_back({movie, count});
+      it = topEntries.end() - 1;
+    } else if (capacity > 0 && count > topEntries.back().count) {
+      topEntries.back() = {movie, count};
+      it = topEntries.end() - 1;
+    } else {
+      return;
+    }
+
+    // Bubble up to restore descending order
+    while (it != topEntries.begin() && (it - 1)->count < it->count) {
+      std::iter_swap(it - 1, it);
+      --it;
+    }
+  }
+
+  // Fill the last slot with the most borrowed title not in the top
+  // entries. Titles outside a full top list never count more than its
+  // last entry, so the title belongs at the end.
+  void refillTop() {
+    Entry best = {nullptr, 0};
+    counts.forEach([&](const Movie *const &movie, const uint32_t &count) {
+      if (count > best.count &&
+          std::none_of(topEntries.begin(), topEntries.end(),
+                       [movie](const Entry &entry) {
+                         return entry.movie == movie;
+                       })) {
+        best = {movie, count};
+      }
+    });
+    if (best.movie != nullptr) {
+      topEntries.push_back(best);
+    }
+  }
+};
+
+#endif // LEADERBOARD_H
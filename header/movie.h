@@ -8,15 +8,28 @@
 #ifndef MOVIE_H
 #define MOVIE_H
 
+#include "formatbuffer.h"
+#include "stringpool.h"
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <vector>
 
 class Movie {
 public:
   virtual ~Movie() = default;
 
+  // Format movie information for inventory output
+  virtual void format(FormatBuffer &out) const = 0;
+
   // Display movie information for inventory output
-  virtual void display(std::ostream &out) const = 0;
+  void display(std::ostream &out) const {
+    thread_local FormatBuffer buffer;
+    buffer.clear();
+    format(buffer);
+    buffer.flushTo(out);
+  }
 
   // Get sorting key based on genre-specific criteria
   virtual std::string getSortingKey() const = 0;
@@ -39,6 +52,35 @@ public:
   // Virtual constructor pattern
   virtual Movie *clone() const = 0;
 
+  // Release month for genres dated by month, 0 otherwise
+  virtual int getReleaseMonth() const { return 0; }
+
+  // Major actors as "FirstName LastName", empty for genres without them
+  virtual std::vector<std::string> getMajorActors() const { return {}; }
+
+  // The same actors, visited in place as first and last name, for output
+  // that should not build the joined strings
+  using ActorVisitor =
+      std::function<void(const std::string &first, const std::string &last)>;
+  virtual size_t getActorCount() const { return 0; }
+  virtual void forEachActor(const ActorVisitor & /*visit*/) const {}
+
+  // Every search key that should find this movie
+  virtual std::vector<std::string> getSearchKeys() const {
+    return {getSearchKey()};
+  }
+
+  // True if key, as built by createSearchKey, identifies this movie
+  virtual bool matchesSearchKey(const std::string &key) const {
+    return getSearchKey() == key;
+  }
+
+  // Rows with equal non-empty keys describe the same physical title
+  virtual std::string getConsolidationKey() const { return ""; }
+
+  // Fold a row with the same consolidation key into this record
+  virtual void mergeFrom(const Movie &other) { stock += other.stock; }
+
   // Concrete methods shared by all movie types
   bool borrowMovie() {
     if (stock > 0) {
@@ -50,18 +92,25 @@ public:
 
   void returnMovie() { stock++; }
   int getStock() const { return stock; }
+  int getYear() const { return year; }
   const std::string &getTitle() const { return title; }
   const std::string &getDirector() const { return director; }
+  const InternedString &getInternedDirector() const { return director; }
+
+  // Position in the store's catalog columns, assigned when stocked
+  uint32_t getCatalogIndex() const { return catalogIndex; }
+  void setCatalogIndex(uint32_t index) { catalogIndex = index; }
 
 protected:
   // Protected constructor - only derived classes can be instantiated
-  Movie() : stock(0), year(0) {}
+  Movie() : stock(0), year(0), catalogIndex(0) {}
 
   // Data members common to all movie types
-  int stock;            // Number of copies available
-  std::string director; // Director name
-  std::string title;    // Movie title
-  int year;             // Release year
+  int stock;               // Number of copies available
+  InternedString director; // Director name
+  InternedString title;    // Movie title
+  int year;                // Release year
+  uint32_t catalogIndex;   // Row in the store's catalog columns
 
   // Helper function for parsing comma-delimited fields
   static std::string parseField(std::istream &input, char delimiter = ',') {
@@ -75,6 +124,11 @@ protected:
     }
     return "";
   }
+
+  // Share storage for names repeated across the catalog
+  static InternedString intern(const std::string &str) {
+    return StringPool::getInstance().intern(str);
+  }
 };
 
 #endif // MOVIE_H
\ No newline at end of file
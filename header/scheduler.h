@@ -0,0 +1,120 @@
+/**
+ * @location header/scheduler.h
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "commandstats.h"
+#include "formatbuffer.h"
+#include "slicedreport.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+
+class Store;
+
+struct SchedulerOptions {
+  // Borrow and Return latency, queueing included, to stay under at p99
+  uint64_t targetMicros = 2000;
+
+  // Movies or transactions rendered between clock checks in a slice
+  size_t itemsPerCheck = 64;
+};
+
+// Runs command lines against one store for many clients on one thread.
+// Borrow and Return go in a short queue that is emptied before every
+// slice of the long queue. Everything else goes in the long queue and
+// runs in arrival order; Inventory and History run in time-bounded
+// slices, so a short command waits for at most one slice.
+//
+// The slice length adapts to the target: it halves whenever a short
+// command misses the target, and grows slowly while they finish within
+// half of it, up to half the target.
+class CommandScheduler {
+public:
+  // Called with everything the command wrote, output and errors
+  // interleaved, once it has finished
+  using Completion =
+      std::function<void(const std::string &response, bool succeeded)>;
+
+  // Takes over the store's output until destroyed, then gives it back
+  explicit CommandScheduler(Store &store,
+                            const SchedulerOptions &options = {});
+  ~CommandScheduler();
+
+  CommandScheduler(const CommandScheduler &) = delete;
+  CommandScheduler &operator=(const CommandScheduler &) = delete;
+
+  // Queue a command line; done may submit more lines
+  void submit(const std::string &line, Completion done);
+
+  // Ingest delta files the store is watching for unless a report is
+  // unfinished, run the short commands queued so far, then one slice of
+  // the oldest long command; true if work remains
+  bool runStep();
+
+  bool hasWork() const { return !shortQueue.empty() || !longQueue.empty(); }
+
+  // Current slice length for long reads
+  uint64_t getSliceMicros() const { return sliceMicros; }
+
+  // Submit-to-completion latency of short commands, in microseconds
+  const LatencyHistogram &getShortLatency() const { return shortLatency; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // Shortest slice, so long reads still make progress under heavy load
+  static constexpr uint64_t MIN_SLICE_MICROS = 50;
+
+  struct Job {
+    std::string line;
+    char commandType = '\0';
+    Completion done;
+    Clock::time_point submitted;
+    bool started = false;
+    bool succeeded = false;
+    std::string response;
+    std::unique_ptr<SlicedReport> report;
+    Clock::duration active = Clock::duration::zero();
+  };
+
+  Store &store;
+
+  // Where the store wrote before the scheduler took over
+  std::ostream &previousOutput;
+  std::ostream &previousErrorOutput;
+
+  SchedulerOptions options;
+  uint64_t sliceMicros;
+
+  std::deque<Job> shortQueue;
+  std::deque<Job> longQueue;
+
+  // Where the store writes while a command starts
+  std::ostringstream capture;
+
+  // A slice's rendering, before it is appended to the job's response
+  FormatBuffer sliceBuffer;
+
+  LatencyHistogram shortLatency;
+
+  // Start job's command, keeping what it wrote; false once it is done
+  bool startJob(Job &job);
+
+  // Render one time-bounded slice of job's report; false once it is done
+  bool renderSlice(Job &job);
+
+  // Ingest watched delta files, reporting to the store's own streams
+  void applyWatchedDeltas();
+
+  // Adapt the slice length to a short command's latency
+  void adjustSlice(uint64_t latencyMicros);
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,163 @@
+/**
+ * @location header/server.h
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+// Long-lived command server around one Store, listening on a Unix domain
+// socket. Clients send newline-terminated command lines in the command
+// file syntax; each non-blank line gets back the output and errors the
+// command wrote, followed by a line holding a single ".".
+//
+// Build with -DSTORE_SERVER -std=c++20 (see runit-server.sh). Every client
+// is a coroutine suspended on an epoll event loop, so an idle client costs
+// a coroutine frame and a file descriptor rather than a thread. Commands
+// run one at a time on the loop thread, so the store needs no locking.
+// A CommandScheduler orders them across clients, so Borrow and Return are
+// not held up behind a long Inventory or History; each client's commands
+// are answered in the order it sent them.
+
+#ifdef STORE_SERVER
+
+#include "scheduler.h"
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+class Store;
+
+// Coroutine that starts at once and frees itself when it finishes
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+// Single-threaded epoll loop resuming coroutines when their descriptor is
+// ready. Each descriptor has at most one waiting coroutine.
+class EventLoop {
+public:
+  EventLoop();
+  ~EventLoop();
+
+  EventLoop(const EventLoop &) = delete;
+  EventLoop &operator=(const EventLoop &) = delete;
+
+  // co_await loop.readable(fd) suspends until fd can be read
+  struct ReadyAwaiter {
+    EventLoop &loop;
+    int fd;
+    uint32_t events;
+
+    bool await_ready() const { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+      return loop.waitFor(fd, events, handle);
+    }
+    void await_resume() const {}
+  };
+
+  ReadyAwaiter readable(int fd);
+  ReadyAwaiter writable(int fd);
+
+  // Close fd and drop it from the loop, freeing a coroutine parked on it.
+  // Descriptors still in the loop are closed when it is destroyed.
+  void closeDescriptor(int fd);
+
+  // Work to do between polls, returning true while more is left; the loop
+  // does not block on a poll while it is
+  void setBackgroundWork(std::function<bool()> work);
+
+  // Resume coroutines as their descriptors become ready, until stop, then
+  // finish the background work
+  void run();
+  void stop() { running = false; }
+
+  bool isOpen() const { return epollFd >= 0; }
+
+private:
+  int epollFd;
+  bool running;
+  std::function<bool()> backgroundWork;
+
+  // Waiting coroutine per descriptor, and descriptors added to epoll
+  std::unordered_map<int, std::coroutine_handle<>> waiting;
+  std::unordered_set<int> registered;
+
+  // Park handle until fd is ready; false (carry on at once) if fd cannot
+  // be watched, leaving the coroutine's next call on it to fail
+  bool waitFor(int fd, uint32_t events, std::coroutine_handle<> handle);
+};
+
+class CommandServer {
+public:
+  explicit CommandServer(Store &store, const SchedulerOptions &options = {});
+  ~CommandServer();
+
+  // Commands to disable on the store before serving it: they read files
+  // on the server's host or change the catalog and customer base, which
+  // is for its operator rather than socket clients
+  static constexpr char ADMIN_COMMANDS[] = "UEK";
+
+  CommandServer(const CommandServer &) = delete;
+  CommandServer &operator=(const CommandServer &) = delete;
+
+  // Bind and listen on socketPath, replacing a stale socket file
+  bool listen(const std::string &socketPath);
+
+  // Serve clients until SIGINT or SIGTERM
+  bool run();
+
+  // Connections accepted so far
+  uint64_t getConnections() const { return connections; }
+
+  const CommandScheduler &getScheduler() const { return scheduler; }
+
+private:
+  // Lines longer than this close the connection
+  static constexpr size_t MAX_LINE_LENGTH = 64 * 1024;
+
+  EventLoop loop;
+  CommandScheduler scheduler;
+  int listenFd;
+  int signalFd;
+  std::string socketPath;
+  uint64_t connections;
+
+  // co_await scheduled(line) suspends until line has run, giving its
+  // response
+  struct ResponseAwaiter {
+    CommandScheduler &scheduler;
+    std::string line;
+    std::string response;
+
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+      scheduler.submit(line, [this, handle](const std::string &text, bool) {
+        response = text;
+        handle.resume();
+      });
+    }
+    std::string await_resume() { return std::move(response); }
+  };
+
+  ResponseAwaiter scheduled(const std::string &line) {
+    return {scheduler, line, {}};
+  }
+
+  DetachedTask acceptClients();
+  DetachedTask serveClient(int fd);
+  DetachedTask waitForSignal();
+};
+
+#endif // STORE_SERVER
+
+#endif // SERVER_H
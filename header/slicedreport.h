@@ -0,0 +1,24 @@
+/**
+ * @location header/slicedreport.h
+ */
+
+#ifndef SLICEDREPORT_H
+#define SLICEDREPORT_H
+
+#include "formatbuffer.h"
+#include <cstddef>
+
+// Output of a long read, such as the inventory or a customer's history,
+// rendered a slice at a time so a scheduler can run other commands in
+// between (see scheduler.h). Concatenated slices match the output of
+// rendering the report in one go.
+class SlicedReport {
+public:
+  virtual ~SlicedReport() = default;
+
+  // Render up to limit more movies or transactions into out; true once
+  // the report is complete
+  virtual bool renderSlice(FormatBuffer &out, size_t limit) = 0;
+};
+
+#endif // SLICEDREPORT_H
@@ -5,10 +5,22 @@
 #ifndef STORE_H
 #define STORE_H
 
+#include "bloomfilter.h"
+#include "catalogcolumns.h"
 #include "command.h"
+#include "commandlog.h"
+#include "commandstats.h"
+#include "corental.h"
 #include "customer.h"
+#include "customerindex.h"
+#include "encoder.h"
+#include "factory.h"
+#include "leaderboard.h"
 #include "movie.h"
+#include "slicedreport.h"
+#include "transactionlog.h"
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -16,8 +28,12 @@
 #include <vector>
 
 // Forward declarations
+class DeltaWatcher;
+class GenreStore;
+class WorkStealingPool;
 template <typename T> class BSTree;
 template <typename K, typename V> class HashTable;
+template <typename V> class Trie;
 
 class Store {
 public:
@@ -31,17 +47,97 @@ public:
   // Process commands from file
   bool processCommands(const std::string &commandFile);
 
-  // Find customer by 4-digit ID
+  // Process one line in the command file syntax
+  bool processCommandLine(const std::string &line);
+
+  // Process one line for a scheduler (see Command::start): a long read
+  // comes back as the report still to render, and recording its execute
+  // time is left to the caller; anything else has run on return
+  std::unique_ptr<SlicedReport> startCommandLine(const std::string &line,
+                                                 bool &succeeded);
+
+  // Process commands from file while capturing them to a binary log (see
+  // commandlog.h), with a checkpoint of the output and state hashes every
+  // checkpointEvery commands (0 for none) and after the last one. Fails
+  // while watching for delta files, as their ingests are not in the log.
+  bool captureCommands(const std::string &commandFile,
+                       const std::string &logFile, size_t checkpointEvery);
+
+  // Run the commands of a captured log, comparing every checkpoint in it.
+  // False if the log cannot be read; divergence is left in report.
+  bool replayCommands(const std::string &logFile, const ReplayOptions &options,
+                      ReplayReport &report);
+
+  // Hash of every title's stock plus customer and transaction counts, to
+  // tell whether two runs left the store in the same state
+  uint64_t stateHash() const;
+
+  // Find customer by ID
   Customer *findCustomer(const std::string &customerID);
 
+  // True if customerID has the form this store's IDs take
+  bool isValidCustomerID(const std::string &customerID) const;
+
   // Find movie by genre and search key
   Movie *findMovie(char movieType, const std::string &searchKey);
 
+  // Retired movie with genre and search key, nullptr if none
+  Movie *findRetiredMovie(char movieType, const std::string &searchKey) const;
+
+  // All movies by a director across genres, nullptr if none
+  const std::vector<Movie *> *findByDirector(const std::string &director) const;
+
+  // All movies featuring a major actor across genres, nullptr if none
+  const std::vector<Movie *> *findByActor(const std::string &actor) const;
+
+  // Closest title to a search key that missed, nullptr if nothing is near
+  const Movie *suggestMovie(char movieType, const std::string &searchKey) const;
+
+  // Movies whose title, director or actor starts with prefix
+  std::vector<const Movie *> autocomplete(const std::string &prefix,
+                                          size_t limit) const;
+
   // Display entire inventory sorted by genre
-  void displayInventory(std::ostream &out) const;
+  void displayInventory(std::ostream &out,
+                        OutputFormat format = OutputFormat::DEFAULT) const;
 
   // Display customer transaction history
-  bool displayCustomerHistory(const std::string &customerID, std::ostream &out);
+  bool displayCustomerHistory(const std::string &customerID, std::ostream &out,
+                              OutputFormat format = OutputFormat::DEFAULT);
+
+  // The same output as displayInventory and displayCustomerHistory, as
+  // reports to render a slice at a time. Stock and new transactions may
+  // change between slices; titles must not be added or removed.
+  std::unique_ptr<SlicedReport>
+  startInventory(OutputFormat format = OutputFormat::DEFAULT) const;
+  std::unique_ptr<SlicedReport>
+  startCustomerHistory(const Customer &customer,
+                       OutputFormat format = OutputFormat::DEFAULT) const;
+
+  // Format used by Inventory and History when a command names none
+  void setOutputFormat(OutputFormat format);
+
+  // Format to use for a command's request, DEFAULT meaning the store's
+  OutputFormat resolveOutputFormat(OutputFormat requested) const;
+
+  // Where commands and the store write output and error reports; std::cout
+  // and std::cerr unless redirected
+  void setOutput(std::ostream &out, std::ostream &err);
+  std::ostream &getOutput() const { return *output; }
+  std::ostream &getErrorOutput() const { return *errorOutput; }
+
+  // Where commands write what is not a record: the output in text format,
+  // the error output otherwise so the output stays machine-readable
+  std::ostream &getMessageOutput() const {
+    return (outputFormat == OutputFormat::TEXT) ? *output : *errorOutput;
+  }
+
+  // Switch a command type or genre off for this store only, as if its
+  // registrar were not linked in; switch genres off before loading
+  void disableCommandType(char commandType);
+  void disableMovieType(char movieType);
+  const TypeMask &getCommandMask() const { return commandMask; }
+  const TypeMask &getMovieTypeMask() const { return movieTypeMask; }
 
   // Add movie to inventory (takes ownership)
   bool addMovie(std::unique_ptr<Movie> movie);
@@ -49,31 +145,254 @@ public:
   // Add customer to database (takes ownership)
   bool addCustomer(std::unique_ptr<Customer> customer);
 
+  // Remove a title from inventory, lookups, indexes and reports. The
+  // movie stays as a tombstone for history and for returning copies
+  // still out. False if no such title is stocked.
+  bool retireMovie(char movieType, const std::string &searchKey);
+
+  // Remove a customer from lookups; their history is kept. False if the
+  // customer is unknown or still has rentals out.
+  bool closeCustomer(const std::string &customerID);
+
+  // Upsert movies from a delta file: a row whose search key matches an
+  // existing title adds its stock to it, other rows become new titles.
+  // Sets count to the number of rows applied; false if the file cannot
+  // be opened.
+  bool ingestMovieDelta(const std::string &filename, int &count);
+
+  // Add customers from a delta file, setting count to how many were
+  // added; false if the file cannot be opened
+  bool ingestCustomerDelta(const std::string &filename, int &count);
+
+  // Ingest delta files that appear in directory, between commands. Names
+  // ending in ".movies" hold movie rows, ".customers" customer rows.
+  bool watchDeltaDirectory(const std::string &directory);
+
+  // Directory being watched for delta files, empty if none
+  std::string getDeltaDirectory() const;
+
+  // Ingest any delta files the watcher has seen; this adds titles, so not
+  // while a sliced report is unfinished
+  void applyWatchedDeltas();
+
+  // Latency and failure counts for the commands run so far
+  CommandStats &getStats() { return stats; }
+  const CommandStats &getStats() const { return stats; }
+
+  // The command stats report, the lookup filters' counts, then how much
+  // interning saved; the string pool is shared by every store
+  void reportStats(std::ostream &out) const;
+
+  // Take one copy off the shelf, false if none are left
+  bool borrowMovie(Movie *movie);
+
+  // Put one copy back on the shelf
+  void returnMovie(Movie *movie);
+
+  // Copies on the shelf across a genre's titles
+  int64_t getShelfCopies(char movieType) const;
+
+  // Titles with fewer than threshold copies on the shelf, in load order
+  std::vector<Movie *> findStockBelow(int threshold) const;
+
+  // Count a successful borrow toward the genre's leaderboard
+  void recordBorrow(const Movie *movie);
+
+  // Pair a customer's borrow with their recent borrows for co-rentals
+  void recordCoRental(const Customer *customer, const Movie *movie);
+
+  // Up to n titles most often rented alongside movie, highest count
+  // first; counts may be overestimated once a title has many neighbours
+  std::vector<Leaderboard::Entry> getCoRentals(const Movie *movie,
+                                               size_t n) const;
+
+  // Up to n most borrowed titles of a genre, highest count first
+  std::vector<Leaderboard::Entry> getTopBorrowed(char movieType,
+                                                 size_t n) const;
+
+  // Most titles getTopBorrowed can return for a genre
+  size_t getTopBorrowedCapacity(char movieType) const;
+
+  // Use Count-Min Sketch estimates instead of exact per-movie counters
+  void useApproximateBorrowCounts(size_t width, size_t depth);
+
+  // Merge rows for the same physical title (e.g. one Classic per film, not
+  // per actor) into a single record with pooled stock; set before loading
+  void setConsolidateRecords(bool enabled);
+
+  // Accept customer IDs of up to 19 digits instead of exactly 4; set
+  // before loading
+  void useWideCustomerIDs(bool enabled);
+
+  // Keep movies in per-genre contiguous arrays of concrete records instead
+  // of heap objects in genre trees; set before loading
+  void useFlatStorage(bool enabled);
+
+  // Render large tree inventories on threads worker threads plus the
+  // caller, each rendering whole subtrees into its own buffer; 0 renders
+  // on the calling thread only. Output is the same either way.
+  void useParallelRendering(size_t threads);
+
+  // Fast-rejection counters for customer and movie lookups
+  const BloomFilter::Stats &getCustomerFilterStats() const;
+  BloomFilter::Stats getMovieFilterStats() const;
+
 private:
   // Map of genre code to BST for that genre's movies
   std::unordered_map<char, std::unique_ptr<BSTree<Movie *>>> genreTrees;
 
-  // Hash table for O(1) customer lookup by ID
-  std::unique_ptr<HashTable<std::string, Customer *>> customers;
+  // Most borrowed titles per genre, updated on every borrow
+  std::unordered_map<char, std::unique_ptr<Leaderboard>> genreLeaderboards;
+
+  // Titles rented together, by catalog index
+  CoRentalIndex coRentals;
+
+  // Command latencies and failure counters
+  CommandStats stats;
+
+  // Secondary indexes across genres, keyed by interned name
+  std::unique_ptr<HashTable<InternedString, std::vector<Movie *>>>
+      directorIndex;
+  std::unique_ptr<HashTable<InternedString, std::vector<Movie *>>> actorIndex;
+
+  // Search keys per genre, for typo-tolerant suggestions on a miss
+  std::unordered_map<char, std::unique_ptr<Trie<Movie *>>> searchKeyTries;
+
+  // Titles, directors and actor names, for prefix autocomplete
+  std::unique_ptr<Trie<Movie *>> nameTrie;
+
+  // Consolidated records by consolidation key, when enabled
+  bool consolidateRecords;
+  std::unique_ptr<HashTable<std::string, Movie *>> consolidatedRecords;
+
+  // Retired movies by genre code plus search key
+  std::unique_ptr<HashTable<std::string, Movie *>> retiredMovies;
 
-  // Ownership of all movies
+  // Bloom filters rejecting unknown customer IDs and search keys early
+  BloomFilter customerFilter;
+  std::unordered_map<char, BloomFilter> searchKeyFilters;
+
+  // Open-addressing customer lookup by numeric ID
+  bool wideCustomerIDs;
+  CustomerIndex customers;
+
+  // Ownership of all movies (tree storage)
   std::vector<std::unique_ptr<Movie>> movieInventory;
 
-  // Ownership of all customers
-  std::vector<std::unique_ptr<Customer>> customerList;
+  // Stock, year and genre per movie as dense columns for catalog scans
+  CatalogColumns catalog;
+
+  // Per-genre contiguous storage, used instead of trees when enabled
+  bool flatStorage;
+  std::unordered_map<char, std::unique_ptr<GenreStore>> flatStores;
+
+  // Workers for rendering the inventory, when enabled
+  std::unique_ptr<WorkStealingPool> renderPool;
+
+  // Ownership of all customers, in fixed-capacity chunks that never move
+  std::vector<std::vector<Customer>> customerChunks;
+
+  // Store-wide format for Inventory and History output
+  OutputFormat outputFormat;
+
+  // Output and error streams, not owned
+  std::ostream *output;
+  std::ostream *errorOutput;
+
+  // Registered types this store treats as unknown
+  TypeMask commandMask;
+  TypeMask movieTypeMask;
+
+  // Source of delta files to ingest, when watching
+  std::unique_ptr<DeltaWatcher> deltaWatcher;
+
+  // Every customer's transactions, in compact records indexing catalog
+  TransactionLog transactionLog;
 
   // Load data from files
   int loadMovies(const std::string &filename);
   int loadCustomers(const std::string &filename);
 
+  // Load customers, quoting lines that fail to parse, or for files from
+  // elsewhere such as deltas, giving only their line numbers
+  bool loadCustomers(const std::string &filename, bool quoteBadLines,
+                     int &count);
+
+  // Merge movie into the title with its search key, else add it
+  bool upsertMovie(std::unique_ptr<Movie> movie);
+
+  // Index source's actors and search keys as pointing at target
+  void indexNamesAndKeys(Movie *target, const Movie &source);
+
+  // Append movie to the list stored under key
+  static void addToIndex(HashTable<InternedString, std::vector<Movie *>> &index,
+                         const InternedString &key, Movie *movie);
+
+  // Remove movie from the list stored under key, dropping emptied keys
+  static void
+  removeFromIndex(HashTable<InternedString, std::vector<Movie *>> &index,
+                  const InternedString &key, Movie *movie);
+
+  // Index lookup by plain name; names never interned cannot be present
+  static const std::vector<Movie *> *
+  findInIndex(const HashTable<InternedString, std::vector<Movie *>> &index,
+              const std::string &name);
+
+  // Resize Bloom filters to the loaded data and refill them
+  void rebuildCustomerFilter();
+  void rebuildSearchKeyFilter(char movieType);
+
+  // Visit every movie of a genre, whatever the storage (in sorting key
+  // order only for trees)
+  void forEachMovie(char movieType,
+                    const std::function<void(Movie *)> &visit) const;
+
+  // Visit every movie of a genre in sorting key order
+  void forEachMovieSorted(
+      char movieType, const std::function<void(const Movie *)> &visit) const;
+
+  // Flat storage for a genre, nullptr if unavailable
+  GenreStore *getFlatStore(char movieType) const;
+
+  // Render the inventory on renderPool, as displayInventory does on one
+  // thread; false, having written nothing, if it is too small to be worth
+  // splitting or not kept in trees
+  bool displayInventoryInParallel(std::ostream &out,
+                                  OutputFormat format) const;
+
   // Get BST for a specific genre
   BSTree<Movie *> *getGenreTree(char movieType);
   const BSTree<Movie *> *getGenreTree(char movieType) const;
 
+  // Parse customer lines, splitting large files across threads; a null
+  // entry marks a line that failed to parse
+  std::vector<std::unique_ptr<Customer>>
+  parseCustomerLines(const std::vector<std::string> &lines) const;
+
+  // Parse one movie file row, nullptr if invalid, after reporting why
+  // when asked to
+  std::unique_ptr<Movie> parseMovieLine(const std::string &line,
+                                        bool reportErrors = true);
+
   // Process single lines from input files
   bool processMovieLine(const std::string &line);
-  bool processCustomerLine(const std::string &line);
-  bool processCommandLine(const std::string &line);
+
+  // Create, parse and execute one command whose type has been read, with
+  // timing from start
+  bool processCommand(char commandType, std::istream &arguments,
+                      CommandStats::Clock::time_point start);
+
+  // Create a command whose type has been read and parse its arguments,
+  // counting failures; nullptr if it cannot run
+  std::unique_ptr<Command> parseCommand(char commandType,
+                                        std::istream &arguments,
+                                        CommandStats::Clock::time_point start);
+
+  // Inventory rendered a genre tree or flat genre at a time
+  class InventoryReport;
+
+  // Route output and errors through one hash until the scope ends
+  class OutputHashScope;
 };
 
 #endif // STORE_H
\ No newline at end of file
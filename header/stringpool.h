@@ -0,0 +1,127 @@
+/**
+ * @location header/stringpool.h
+ */
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+// Handle to a pooled string: equal strings share one handle
+class InternedString {
+public:
+  InternedString() : ptr(&emptyString()) {}
+
+  const std::string &str() const { return *ptr; }
+  operator const std::string &() const { return *ptr; }
+  bool empty() const { return ptr->empty(); }
+
+  // Address of the pooled string, identifying it for hashing
+  const void *id() const { return ptr; }
+
+  // Pooled strings are unique, so identical handles mean equal strings
+  bool operator==(const InternedString &other) const {
+    return ptr == other.ptr;
+  }
+  bool operator!=(const InternedString &other) const {
+    return ptr != other.ptr;
+  }
+  bool operator<(const InternedString &other) const {
+    return ptr != other.ptr && *ptr < *other.ptr;
+  }
+
+  friend std::ostream &operator<<(std::ostream &out,
+                                  const InternedString &interned) {
+    return out << *interned.ptr;
+  }
+
+private:
+  friend class StringPool;
+
+  explicit InternedString(const std::string *str) : ptr(str) {}
+
+  static const std::string &emptyString() {
+    static const std::string empty;
+    return empty;
+  }
+
+  const std::string *ptr; // Owned by StringPool, never freed
+};
+
+namespace std {
+template <> struct hash<InternedString> {
+  size_t operator()(const InternedString &interned) const {
+    return std::hash<const void *>{}(interned.id());
+  }
+};
+} // namespace std
+
+// Process-wide pool of deduplicated strings for movie names
+class StringPool {
+public:
+  // Singleton instance
+  static StringPool &getInstance() {
+    static StringPool instance;
+    return instance;
+  }
+
+  // Handle for str, adding it to the pool on first use
+  InternedString intern(const std::string &str) {
+    if (str.empty()) {
+      return InternedString();
+    }
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    requestedBytes += str.size();
+    auto result = strings.insert(str);
+    if (result.second) {
+      uniqueBytes += str.size();
+    }
+    return InternedString(&*result.first);
+  }
+
+  // Handle for str if it was ever interned, without adding it
+  bool lookup(const std::string &str, InternedString &interned) const {
+    if (str.empty()) {
+      interned = InternedString();
+      return true;
+    }
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto it = strings.find(str);
+    if (it == strings.end()) {
+      return false;
+    }
+    interned = InternedString(&*it);
+    return true;
+  }
+
+  // Number of distinct strings held
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return strings.size();
+  }
+
+  // Character bytes not stored because they were duplicates
+  size_t bytesSaved() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return requestedBytes - uniqueBytes;
+  }
+
+private:
+  StringPool() : requestedBytes(0), uniqueBytes(0) {}
+  StringPool(const StringPool &) = delete;
+  StringPool &operator=(const StringPool &) = delete;
+
+  // Node-based set keeps element addresses stable across rehashing
+  std::unordered_set<std::string> strings;
+  size_t requestedBytes;
+  size_t uniqueBytes;
+  mutable std::mutex poolMutex;
+};
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,148 @@
+/**
+ * @location header/tracing.h
+ */
+
+#ifndef TRACING_H
+#define TRACING_H
+
+// Scoped timing spans written as a Chrome trace-event JSON file, for
+// opening in Perfetto (ui.perfetto.dev) or chrome://tracing.
+//
+// Build with -DSTORE_TRACING to record. Each thread appends to its own
+// buffer without locking; all buffers are written out when the program
+// exits, to the file named by STORE_TRACE_FILE (default trace.json).
+// Without STORE_TRACING the macros expand to nothing.
+//
+//   TRACE_SCOPE("loadMovies");        // Span until the end of the scope
+//   TRACE_SCOPE_TYPE("execute", 'B'); // Span with a type letter argument
+//
+// Span names must be string literals; only the pointer is stored.
+
+#ifdef STORE_TRACING
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class TraceRecorder {
+public:
+  struct Event {
+    const char *name;
+    int64_t startNs;
+    int64_t durationNs;
+    char type; // '\0' if the span has no type argument
+  };
+
+  // Events recorded on one thread
+  struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t threadID) : threadID(threadID) {}
+    uint32_t threadID;
+    std::vector<Event> events;
+  };
+
+  static TraceRecorder &getInstance() {
+    static TraceRecorder instance;
+    return instance;
+  }
+
+  // Nanoseconds since the recorder started
+  int64_t now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - origin)
+        .count();
+  }
+
+  // The calling thread's buffer, created on its first span. Buffers are
+  // owned here so events outlive the threads that recorded them.
+  ThreadBuffer &threadBuffer() {
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer == nullptr) {
+      std::lock_guard<std::mutex> lock(mutex);
+      buffers.push_back(std::make_unique<ThreadBuffer>(
+          static_cast<uint32_t>(buffers.size() + 1)));
+      buffer = buffers.back().get();
+    }
+    return *buffer;
+  }
+
+  ~TraceRecorder() { write(); }
+
+private:
+  std::chrono::steady_clock::time_point origin;
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+  TraceRecorder() : origin(std::chrono::steady_clock::now()) {}
+  TraceRecorder(const TraceRecorder &) = delete;
+  TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+  // Complete ("X") events with microsecond timestamps
+  void write() {
+    const char *path = std::getenv("STORE_TRACE_FILE");
+    std::FILE *file = std::fopen(path != nullptr ? path : "trace.json", "w");
+    if (file == nullptr) {
+      return;
+    }
+
+    std::fputs("{\"traceEvents\":[\n", file);
+    const char *separator = "";
+    for (const auto &buffer : buffers) {
+      for (const Event &event : buffer->events) {
+        std::fprintf(file,
+                     "%s{\"name\":\"%s\",\"cat\":\"store\",\"ph\":\"X\","
+                     "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u",
+                     separator, event.name, event.startNs / 1000.0,
+                     event.durationNs / 1000.0, buffer->threadID);
+        if (event.type != '\0') {
+          std::fprintf(file, ",\"args\":{\"type\":\"%c\"}", event.type);
+        }
+        std::fputs("}", file);
+        separator = ",\n";
+      }
+    }
+    std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+    std::fclose(file);
+  }
+};
+
+// Records one event covering its own lifetime
+class TraceSpan {
+public:
+  explicit TraceSpan(const char *name, char type = '\0')
+      : name(name), type(type),
+        startNs(TraceRecorder::getInstance().now()) {}
+
+  ~TraceSpan() {
+    TraceRecorder &recorder = TraceRecorder::getInstance();
+    int64_t endNs = recorder.now();
+    recorder.threadBuffer().events.push_back(
+        {name, startNs, endNs - startNs, type});
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+  const char *name;
+  char type;
+  int64_t startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_SCOPE_TYPE(name, type)                                          \
+  TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name, type)
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_TYPE(name, type)
+
+#endif // STORE_TRACING
+
+#endif // TRACING_H
@@ -0,0 +1,217 @@
+/**
+ * @location header/transactionlog.h
+ */
+
+#ifndef TRANSACTIONLOG_H
+#define TRANSACTIONLOG_H
+
+#include "catalogcolumns.h"
+#include "formatbuffer.h"
+#include "movie.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Single transaction record
+class Transaction {
+public:
+  enum Type { BORROW, RETURN };
+
+  Transaction(Type type, const Movie *movie, uint32_t sequence = 0)
+      : transactionType(type), moviePtr(movie), sequenceNumber(sequence) {}
+
+  // Simple display for sample output compliance
+  void format(FormatBuffer &out) const {
+    out << (transactionType == BORROW ? "Borrow " : "Return ");
+    out << moviePtr->getTitle();
+  }
+
+  // Detailed display showing full movie information
+  void formatDetailed(FormatBuffer &out) const {
+    out << (transactionType == BORROW ? "Borrow " : "Return ");
+    out << moviePtr->getTitle() << " ";
+    moviePtr->format(out);
+  }
+
+  Type getType() const { return transactionType; }
+  const Movie *getMovie() const { return moviePtr; }
+
+  // Position in the store-wide order of transactions
+  uint32_t getSequence() const { return sequenceNumber; }
+
+private:
+  Type transactionType;
+  const Movie *moviePtr; // Non-owning pointer
+  uint32_t sequenceNumber;
+};
+
+// Transaction packed into 8 bytes: the movie's catalog index in the low
+// word, then a type bit over a 31-bit sequence number in the high word
+class CompactTransaction {
+public:
+  static constexpr uint32_t SEQUENCE_MASK = 0x7FFFFFFF;
+
+  CompactTransaction() : bits(0) {}
+  CompactTransaction(Transaction::Type type, uint32_t movieIndex,
+                     uint32_t sequence)
+      : bits(uint64_t{movieIndex} |
+             uint64_t{type == Transaction::RETURN ? 1u : 0u} << 63 |
+             uint64_t{sequence & SEQUENCE_MASK} << 32) {}
+
+  // Rebuild from the raw encoding, e.g. when reading a saved log
+  static CompactTransaction fromBits(uint64_t raw) {
+    CompactTransaction record;
+    record.bits = raw;
+    return record;
+  }
+
+  Transaction::Type getType() const {
+    return (bits >> 63) != 0 ? Transaction::RETURN : Transaction::BORROW;
+  }
+  uint32_t getMovieIndex() const { return static_cast<uint32_t>(bits); }
+  uint32_t getSequence() const {
+    return static_cast<uint32_t>(bits >> 32) & SEQUENCE_MASK;
+  }
+
+  // Raw encoding, suitable for writing out as is
+  uint64_t getBits() const { return bits; }
+
+private:
+  uint64_t bits;
+};
+
+static_assert(sizeof(CompactTransaction) == 8,
+              "CompactTransaction must pack into 8 bytes");
+
+// Append-only log of every customer's transactions. Records live in
+// cache-line sized segments from one shared pool; each customer owns a
+// chain of segments, so histories stay in order without a vector per
+// customer. Movies are stored as catalog indexes and resolved on read.
+class TransactionLog {
+public:
+  explicit TransactionLog(const CatalogColumns &catalog)
+      : catalog(catalog), numRecords(0), nextSequence(0) {}
+
+  // No copying: customers refer to the log by address
+  TransactionLog(const TransactionLog &) = delete;
+  TransactionLog &operator=(const TransactionLog &) = delete;
+
+  // Start an empty history, returning its handle
+  uint32_t addHistory() {
+    histories.push_back({NO_SEGMENT, NO_SEGMENT});
+    return static_cast<uint32_t>(histories.size() - 1);
+  }
+
+  // Add a transaction to the end of a history
+  void append(uint32_t history, Transaction::Type type, const Movie *movie) {
+    Chain &chain = histories[history];
+    if (chain.tail == NO_SEGMENT ||
+        segments[chain.tail].count == SEGMENT_SIZE) {
+      uint32_t segment = static_cast<uint32_t>(segments.size());
+      segments.emplace_back();
+      if (chain.tail == NO_SEGMENT) {
+        chain.head = segment;
+      } else {
+        segments[chain.tail].next = segment;
+      }
+      chain.tail = segment;
+    }
+
+    Segment &tail = segments[chain.tail];
+    tail.records[tail.count++] =
+        CompactTransaction(type, movie->getCatalogIndex(), nextSequence);
+    numRecords++;
+    nextSequence = (nextSequence + 1) & CompactTransaction::SEQUENCE_MASK;
+  }
+
+  // Visit a history's transactions in the order they happened
+  template <typename Visit> void forEach(uint32_t history, Visit visit) const {
+    for (uint32_t segment = histories[history].head; segment != NO_SEGMENT;
+         segment = segments[segment].next) {
+      const Segment &current = segments[segment];
+      for (uint32_t i = 0; i < current.count; i++) {
+        const CompactTransaction &record = current.records[i];
+        visit(Transaction(record.getType(),
+                          catalog.movieAt(record.getMovieIndex()),
+                          record.getSequence()));
+      }
+    }
+  }
+
+  // Place in a history, to visit it a few records at a time. The end is
+  // fixed when the cursor is made, so records appended later are left out.
+  struct Cursor {
+    uint32_t segment;
+    uint32_t index;
+    uint32_t endSegment;
+    uint32_t endCount;
+  };
+
+  // Cursor over the records a history holds now
+  Cursor cursor(uint32_t history) const {
+    const Chain &chain = histories[history];
+    uint32_t endCount =
+        (chain.tail != NO_SEGMENT) ? segments[chain.tail].count : 0;
+    return {chain.head, 0, chain.tail, endCount};
+  }
+
+  // Visit up to limit records from cursor on, moving it past them; true
+  // once the cursor has reached its end
+  template <typename Visit>
+  bool forEachFrom(Cursor &cursor, size_t limit, Visit visit) const {
+    for (; cursor.segment != NO_SEGMENT; cursor.index = 0) {
+      const Segment &current = segments[cursor.segment];
+      bool last = cursor.segment == cursor.endSegment;
+      uint32_t count = last ? cursor.endCount : current.count;
+      for (; cursor.index < count; cursor.index++) {
+        if (limit-- == 0) {
+          return false;
+        }
+        const CompactTransaction &record = current.records[cursor.index];
+        visit(Transaction(record.getType(),
+                          catalog.movieAt(record.getMovieIndex()),
+                          record.getSequence()));
+      }
+      cursor.segment = last ? NO_SEGMENT : current.next;
+    }
+    return true;
+  }
+
+  bool empty(uint32_t history) const {
+    return histories[history].head == NO_SEGMENT;
+  }
+
+  // Total transactions appended across all histories
+  size_t size() const { return numRecords; }
+
+  // Bytes held by segments and history chains
+  size_t memoryUsage() const {
+    return segments.capacity() * sizeof(Segment) +
+           histories.capacity() * sizeof(Chain);
+  }
+
+private:
+  static constexpr uint32_t NO_SEGMENT = 0xFFFFFFFF;
+  static constexpr uint32_t SEGMENT_SIZE = 7;
+
+  // 7 records plus link and count fill one 64-byte cache line
+  struct Segment {
+    CompactTransaction records[SEGMENT_SIZE];
+    uint32_t next = NO_SEGMENT;
+    uint32_t count = 0;
+  };
+
+  // First and last segment of one customer's history
+  struct Chain {
+    uint32_t head;
+    uint32_t tail;
+  };
+
+  const CatalogColumns &catalog;
+  std::vector<Segment> segments;
+  std::vector<Chain> histories;
+  size_t numRecords;
+  uint32_t nextSequence; // Wraps at 31 bits
+};
+
+#endif // TRANSACTIONLOG_H
@@ -0,0 +1,243 @@
+/**
+ * @location header/trie.h
+ */
+
+#ifndef TRIE_H
+#define TRIE_H
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compressed trie (radix tree) mapping strings to values, with prefix and
+// bounded edit-distance lookups
+template <typename V> class Trie {
+private:
+  struct Node {
+    std::string label; // Edge label leading into this node
+    std::vector<std::unique_ptr<Node>> children; // Sorted by first char
+    std::vector<V> values;                       // Values stored at this key
+  };
+
+  Node root;
+  size_t keyCount;
+
+  // Index of the child whose label starts with c, or children.size()
+  static size_t findChild(const Node &node, char c) {
+    auto it = std::lower_bound(
+        node.children.begin(), node.children.end(), c,
+        [](const std::unique_ptr<Node> &child, char ch) {
+          return child->label[0] < ch;
+        });
+    if (it != node.children.end() && (*it)->label[0] == c) {
+      return it - node.children.begin();
+    }
+    return node.children.size();
+  }
+
+  static void addChild(Node &node, std::unique_ptr<Node> child) {
+    char c = child->label[0];
+    auto it = std::lower_bound(
+        node.children.begin(), node.children.end(), c,
+        [](const std::unique_ptr<Node> &existing, char ch) {
+          return existing->label[0] < ch;
+        });
+    node.children.insert(it, std::move(child));
+  }
+
+  // Node reached by exactly key, nullptr if the path does not exist
+  template <typename NodeType>
+  static NodeType *findNode(NodeType &start, const std::string &key) {
+    NodeType *node = &start;
+    size_t pos = 0;
+
+    while (pos < key.size()) {
+      size_t index = findChild(*node, key[pos]);
+      if (index == node->children.size()) {
+        return nullptr;
+      }
+
+      NodeType *child = node->children[index].get();
+      if (key.compare(pos, child->label.size(), child->label) != 0) {
+        return nullptr;
+      }
+
+      pos += child->label.size();
+      node = child;
+    }
+    return node;
+  }
+
+  // Collect values below node in key order, up to limit
+  static void collect(const Node &node, std::vector<V> &out, size_t limit) {
+    for (const V &value : node.values) {
+      if (out.size() >= limit) {
+        return;
+      }
+      out.push_back(value);
+    }
+    for (const auto &child : node.children) {
+      if (out.size() >= limit) {
+        return;
+      }
+      collect(*child, out, limit);
+    }
+  }
+
+  // Levenshtein walk: row holds distances from the query to the current path
+  void nearestHelper(const Node &node, const std::string &key,
+                     const std::vector<size_t> &parentRow, size_t &best,
+                     const V *&bestValue) const {
+    std::vector<size_t> row = parentRow;
+    std::vector<size_t> next(key.size() + 1);
+
+    for (char c : node.label) {
+      next[0] = row[0] + 1;
+      size_t rowMin = next[0];
+      for (size_t i = 1; i <= key.size(); i++) {
+        size_t substitute = row[i - 1] + (key[i - 1] == c ? 0 : 1);
+        next[i] = std::min({next[i - 1] + 1, row[i] + 1, substitute});
+        rowMin = std::min(rowMin, next[i]);
+      }
+      row.swap(next);
+
+      // No completion of this path can beat the best so far
+      if (rowMin > best) {
+        return;
+      }
+    }
+
+    size_t distance = row[key.size()];
+    if (!node.values.empty() && distance <= best &&
+        (bestValue == nullptr || distance < best)) {
+      best = distance;
+      bestValue = &node.values.front();
+    }
+
+    for (const auto &child : node.children) {
+      nearestHelper(*child, key, row, best, bestValue);
+    }
+  }
+
+public:
+  Trie() : keyCount(0) {}
+
+  // No copying
+  Trie(const Trie &) = delete;
+  Trie &operator=(const Trie &) = delete;
+
+  // Add value under key, splitting edges as needed
+  void insert(const std::string &key, const V &value) {
+    Node *node = &root;
+    size_t pos = 0;
+
+    while (pos < key.size()) {
+      size_t index = findChild(*node, key[pos]);
+      if (index == node->children.size()) {
+        auto leaf = std::make_unique<Node>();
+        leaf->label = key.substr(pos);
+        leaf->values.push_back(value);
+        addChild(*node, std::move(leaf));
+        keyCount++;
+        return;
+      }
+
+      std::unique_ptr<Node> &child = node->children[index];
+      const std::string &label = child->label;
+      size_t common = 0;
+      while (common < label.size() && pos + common < key.size() &&
+             label[common] == key[pos + common]) {
+        common++;
+      }
+
+      // Key diverges inside the edge: split it at the common prefix
+      if (common < label.size()) {
+        auto middle = std::make_unique<Node>();
+        middle->label = label.substr(0, common);
+        child->label.erase(0, common);
+        middle->children.push_back(std::move(child));
+        child = std::move(middle);
+      }
+
+      pos += common;
+      node = child.get();
+    }
+
+    if (node->values.empty()) {
+      keyCount++;
+    }
+    node->values.push_back(value);
+  }
+
+  // Values stored under exactly key, nullptr if none
+  const std::vector<V> *find(const std::string &key) const {
+    const Node *node = findNode(root, key);
+    return (node == nullptr || node->values.empty()) ? nullptr
+                                                      : &node->values;
+  }
+
+  // Remove one value stored under key; false if it is not there. Emptied
+  // nodes are left in place and skipped by lookups.
+  bool erase(const std::string &key, const V &value) {
+    Node *node = findNode(root, key);
+    if (node == nullptr) {
+      return false;
+    }
+
+    auto it = std::find(node->values.begin(), node->values.end(), value);
+    if (it == node->values.end()) {
+      return false;
+    }
+
+    node->values.erase(it);
+    if (node->values.empty()) {
+      keyCount--;
+    }
+    return true;
+  }
+
+  // Values whose key starts with prefix, in key order, up to limit
+  std::vector<V> findPrefix(const std::string &prefix, size_t limit) const {
+    std::vector<V> result;
+    const Node *node = &root;
+    size_t pos = 0;
+
+    while (pos < prefix.size()) {
+      size_t index = findChild(*node, prefix[pos]);
+      if (index == node->children.size()) {
+        return result;
+      }
+
+      const Node *child = node->children[index].get();
+      size_t length = std::min(child->label.size(), prefix.size() - pos);
+      if (child->label.compare(0, length, prefix, pos, length) != 0) {
+        return result;
+      }
+
+      pos += length;
+      node = child;
+    }
+
+    collect(*node, result, limit);
+    return result;
+  }
+
+  // Value whose key is closest to key within maxDistance edits, or nullptr
+  const V *findNearest(const std::string &key, size_t maxDistance) const {
+    std::vector<size_t> row(key.size() + 1);
+    for (size_t i = 0; i <= key.size(); i++) {
+      row[i] = i;
+    }
+
+    size_t best = maxDistance;
+    const V *bestValue = nullptr;
+    nearestHelper(root, key, row, best, bestValue);
+    return bestValue;
+  }
+
+  bool empty() const { return keyCount == 0; }
+  size_t size() const { return keyCount; }
+};
+
+#endif // TRIE_H
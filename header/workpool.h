@@ -0,0 +1,68 @@
+/**
+ * @location header/workpool.h
+ */
+
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for running a batch of independent tasks.
+// Each worker, and the thread that submits the batch, has its own task
+// deque: it takes its newest task first and, once that runs dry, steals
+// the oldest task of another, so tasks of uneven size even out without
+// every worker contending for one shared queue.
+class WorkStealingPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingPool(size_t threads);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool &) = delete;
+  WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+  // Worker threads, not counting the caller of runAll
+  size_t size() const { return threads.size(); }
+
+  // Run every task on the workers and the calling thread, returning once
+  // all have finished; one batch runs at a time
+  void runAll(std::vector<Task> &tasks);
+
+private:
+  struct TaskDeque {
+    std::mutex mutex;
+    std::deque<Task *> tasks;
+  };
+
+  // One deque per worker, then one for the caller of runAll
+  std::vector<std::unique_ptr<TaskDeque>> deques;
+  std::vector<std::thread> threads;
+
+  std::mutex batchMutex; // Held for the whole of runAll
+
+  // Sleeping workers wait on wake; runAll waits on finished
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+  std::condition_variable finished;
+  bool stopping;
+
+  std::atomic<size_t> unclaimed; // Tasks queued but not yet taken
+  std::atomic<size_t> remaining; // Tasks of the batch not yet finished
+
+  void workerLoop(size_t index);
+
+  // Take and run a task from deque index, or else steal one; false if
+  // none was left anywhere
+  bool runOne(size_t index);
+};
+
+#endif // WORKPOOL_H
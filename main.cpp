@@ -3,18 +3,165 @@
  *
  * This program initializes the movie store with inventory and customer data,
  * then processes a series of commands from a file.
+ *
+ * Usage: ./a.out [--format=text|json|csv|binary] [--watch=DIR] [--stats]
+ *                [--render-threads=N] [--consolidate] [--wide-ids] [--flat]
+ *                [--approximate-counts=WIDTH,DEPTH]
+ *                [--capture=LOG [--checkpoint=N] | --replay=LOG [--speed=X]]
+ *        ./a.out --test
+ *   --format      output format for Inventory and History commands that do
+ *                 not name one (default text)
+ *   --watch       ingest *.movies and *.customers delta files written to DIR
+ *                 while commands run; U commands read files from DIR
+ *   --stats       print command latencies, failure counts, filter counts
+ *                 and string pool savings to stderr at exit
+ *   --consolidate merge rows for the same film, such as a Classic listed
+ *                 once per actor, into one record with their stock pooled
+ *   --wide-ids    accept customer IDs of 1 to 19 digits, without leading
+ *                 zeros, instead of exactly 4
+ *   --flat        keep each genre's movies in contiguous arrays instead of
+ *                 trees of heap objects
+ *   --approximate-counts
+ *                 count borrows for T in a Count-Min Sketch of DEPTH rows
+ *                 of WIDTH counters per genre, instead of exactly
+ *   --render-threads
+ *                 render large inventories on N extra threads (default 0)
+ *   --capture     also write the commands to a binary log for replay; not
+ *                 with --watch, whose ingests the log cannot hold
+ *   --checkpoint  record output and state hashes in the log every N
+ *                 commands (default 1000)
+ *   --replay      run the commands in LOG instead of data4commands.txt and
+ *                 report any checkpoint that does not match
+ *   --speed       replay at X times the captured pace (default 0, as fast
+ *                 as possible)
+ *   --test        run the unit tests in store_test.cpp instead (see
+ *                 runit-tests.sh)
+ *
+ * Built with -DSTORE_SERVER (see runit-server.sh) it also takes
+ *   --serve=SOCKET  after loading the data, serve command lines on a Unix
+ *                   socket until SIGINT or SIGTERM instead of running
+ *                   data4commands.txt; clients cannot run U, E or K
+ *   --target=MICROS Borrow and Return p99 latency the server schedules
+ *                   long reads around (default 2000)
  */
 
+#include "header/server.h"
 #include "header/store.h"
+#include <cstdlib>
 #include <exception>
 #include <iostream>
 #include <string>
 
-int main() {
+// Every unit test, defined in store_test.cpp
+void testAll();
+
+int main(int argc, char *argv[]) {
   try {
     // Create the store instance
     Store movieStore;
 
+    // Optional flags
+    const std::string formatFlag = "--format=";
+    const std::string watchFlag = "--watch=";
+    const std::string captureFlag = "--capture=";
+    const std::string checkpointFlag = "--checkpoint=";
+    const std::string replayFlag = "--replay=";
+    const std::string speedFlag = "--speed=";
+    const std::string renderThreadsFlag = "--render-threads=";
+    const std::string approximateFlag = "--approximate-counts=";
+    std::string watchDirectory;
+    std::string captureLog;
+    std::string replayLog;
+    size_t checkpointEvery = 1000;
+    ReplayOptions replayOptions;
+    bool printStats = false;
+    bool runTests = false;
+    bool usageError = false;
+#ifdef STORE_SERVER
+    const std::string serveFlag = "--serve=";
+    const std::string targetFlag = "--target=";
+    std::string serveSocket;
+    SchedulerOptions schedulerOptions;
+#endif
+    for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      OutputFormat format;
+      if (arg.compare(0, formatFlag.size(), formatFlag) == 0 &&
+          parseOutputFormat(arg.substr(formatFlag.size()), format)) {
+        movieStore.setOutputFormat(format);
+      } else if (arg.compare(0, watchFlag.size(), watchFlag) == 0) {
+        watchDirectory = arg.substr(watchFlag.size());
+      } else if (arg == "--stats") {
+        printStats = true;
+      } else if (arg == "--test" && argc == 2) {
+        runTests = true;
+      } else if (arg.compare(0, captureFlag.size(), captureFlag) == 0) {
+        captureLog = arg.substr(captureFlag.size());
+      } else if (arg.compare(0, checkpointFlag.size(), checkpointFlag) == 0) {
+        checkpointEvery = std::strtoul(arg.c_str() + checkpointFlag.size(),
+                                       nullptr, 10);
+      } else if (arg.compare(0, replayFlag.size(), replayFlag) == 0) {
+        replayLog = arg.substr(replayFlag.size());
+      } else if (arg.compare(0, speedFlag.size(), speedFlag) == 0) {
+        replayOptions.speed = std::atof(arg.c_str() + speedFlag.size());
+      } else if (arg == "--consolidate") {
+        movieStore.setConsolidateRecords(true);
+      } else if (arg == "--wide-ids") {
+        movieStore.useWideCustomerIDs(true);
+      } else if (arg == "--flat") {
+        movieStore.useFlatStorage(true);
+      } else if (arg.compare(0, approximateFlag.size(), approximateFlag) ==
+                 0) {
+        char *end = nullptr;
+        size_t width =
+            std::strtoul(arg.c_str() + approximateFlag.size(), &end, 10);
+        size_t depth = (*end == ',') ? std::strtoul(end + 1, &end, 10) : 0;
+        if (width == 0 || depth == 0 || *end != '\0') {
+          usageError = true;
+        } else {
+          movieStore.useApproximateBorrowCounts(width, depth);
+        }
+      } else if (arg.compare(0, renderThreadsFlag.size(), renderThreadsFlag) ==
+                 0) {
+        movieStore.useParallelRendering(std::strtoul(
+            arg.c_str() + renderThreadsFlag.size(), nullptr, 10));
+#ifdef STORE_SERVER
+      } else if (arg.compare(0, serveFlag.size(), serveFlag) == 0) {
+        serveSocket = arg.substr(serveFlag.size());
+      } else if (arg.compare(0, targetFlag.size(), targetFlag) == 0) {
+        schedulerOptions.targetMicros =
+            std::strtoull(arg.c_str() + targetFlag.size(), nullptr, 10);
+#endif
+      } else {
+        usageError = true;
+      }
+    }
+    // A capture must hold everything that changes the store, which delta
+    // files picked up by a watch are not
+    if (usageError || (!captureLog.empty() && !replayLog.empty()) ||
+        (!captureLog.empty() && !watchDirectory.empty())) {
+      std::cerr << "Usage: " << argv[0]
+                << " [--format=text|json|csv|binary] [--watch=DIR]"
+                   " [--stats]\n"
+                   "       [--render-threads=N] [--consolidate]"
+                   " [--wide-ids] [--flat]\n"
+                   "       [--approximate-counts=WIDTH,DEPTH]\n"
+                   "       [--capture=LOG [--checkpoint=N] |"
+                   " --replay=LOG [--speed=X]]"
+#ifdef STORE_SERVER
+                   "\n       [--serve=SOCKET [--target=MICROS]]"
+#endif
+                   "\n   or: "
+                << argv[0] << " --test" << std::endl;
+      return 1;
+    }
+
+    // Tests load the data files themselves; a failure aborts
+    if (runTests) {
+      testAll();
+      return 0;
+    }
+
     // File paths for data files
     const std::string movieFile = "data4movies.txt";
     const std::string customerFile = "data4customers.txt";
@@ -26,13 +173,83 @@ int main() {
       return 1;
     }
 
-    // Process commands from the command file
-    if (!movieStore.processCommands(commandFile)) {
+    // Watch for delta files once the base data is loaded
+    if (!watchDirectory.empty() &&
+        !movieStore.watchDeltaDirectory(watchDirectory)) {
+      return 1;
+    }
+
+#ifdef STORE_SERVER
+    // Serve clients in place of the command file, keeping admin commands
+    // to the operator
+    if (!serveSocket.empty()) {
+      for (const char *type = CommandServer::ADMIN_COMMANDS; *type != '\0';
+           type++) {
+        movieStore.disableCommandType(*type);
+      }
+      CommandServer server(movieStore, schedulerOptions);
+      if (!server.listen(serveSocket)) {
+        return 1;
+      }
+      std::cerr << "Listening on " << serveSocket << std::endl;
+      if (!server.run()) {
+        return 1;
+      }
+      const LatencyHistogram &shortLatency =
+          server.getScheduler().getShortLatency();
+      std::cerr << "Served " << server.getConnections() << " connections; "
+                << "Borrow/Return p99 " << shortLatency.percentile(0.99)
+                << " us, max " << shortLatency.getMax() << " us"
+                << std::endl;
+      if (printStats) {
+        movieStore.reportStats(std::cerr);
+      }
+      return 0;
+    }
+#endif
+
+    // Replay a captured log in place of the command file
+    if (!replayLog.empty()) {
+      ReplayReport report;
+      if (!movieStore.replayCommands(replayLog, replayOptions, report)) {
+        std::cerr << "Failed to replay command log" << std::endl;
+        return 1;
+      }
+      movieStore.getMessageOutput() << "Done!" << std::endl;
+      std::cerr << "Replayed " << report.commands << " commands in "
+                << report.elapsedMillis << " ms, "
+                << report.checkpointsMatched << " checkpoints matched, "
+                << report.checkpointsDiverged << " diverged" << std::endl;
+      if (report.checkpointsDiverged > 0) {
+        std::cerr << "First divergence after " << report.actual.commands
+                  << " commands: output hash " << std::hex
+                  << report.actual.outputHash << " (expected "
+                  << report.expected.outputHash << "), state hash "
+                  << report.actual.stateHash << " (expected "
+                  << report.expected.stateHash << ")" << std::dec
+                  << std::endl;
+      }
+      if (printStats) {
+        movieStore.reportStats(std::cerr);
+      }
+      return (report.checkpointsDiverged == 0) ? 0 : 1;
+    }
+
+    // Process commands from the command file, capturing them if asked
+    bool processed =
+        captureLog.empty()
+            ? movieStore.processCommands(commandFile)
+            : movieStore.captureCommands(commandFile, captureLog,
+                                         checkpointEvery);
+    if (!processed) {
       std::cerr << "Failed to process command file" << std::endl;
       return 1;
     }
 
-    std::cout << "Done!" << std::endl;
+    movieStore.getMessageOutput() << "Done!" << std::endl;
+    if (printStats) {
+      movieStore.reportStats(std::cerr);
+    }
     return 0;
   } catch (const std::exception &e) {
     std::cerr << "Error: " << e.what() << std::endl;
@@ -0,0 +1,133 @@
+#!/bin/bash
+
+# Compile and run the benchmarks with optimization
+
+echo "====================================================="
+echo "Compiling benchmarks"
+echo "====================================================="
+
+rm ./storage_bench ./corental_bench ./workload_gen ./store_bench ./micro_bench \
+    2>/dev/null
+
+g++ -I./header -O2 -Wall -Wextra -Wno-sign-compare \
+    bench/storage_bench.cpp \
+    src/classic.cpp \
+    src/comedy.cpp \
+    src/drama.cpp \
+    src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
+    src/inventory_command.cpp \
+    src/history_command.cpp \
+    src/borrow_command.cpp \
+    src/return_command.cpp \
+    -o storage_bench &&
+g++ -I./header -O2 -Wall -Wextra -Wno-sign-compare \
+    bench/store_bench.cpp \
+    src/classic.cpp \
+    src/comedy.cpp \
+    src/drama.cpp \
+    src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/corental_command.cpp \
+    src/close_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
+    src/inventory_command.cpp \
+    src/history_command.cpp \
+    src/borrow_command.cpp \
+    src/return_command.cpp \
+    -o store_bench &&
+g++ -I./header -O2 -Wall -Wextra -Wno-sign-compare \
+    bench/micro_bench.cpp \
+    src/classic.cpp \
+    src/comedy.cpp \
+    src/drama.cpp \
+    src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/corental_command.cpp \
+    src/close_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
+    src/inventory_command.cpp \
+    src/history_command.cpp \
+    src/borrow_command.cpp \
+    src/return_command.cpp \
+    -o micro_bench &&
+g++ -I./header -O2 -Wall -Wextra -Wno-sign-compare \
+    bench/workload_gen.cpp \
+    -o workload_gen &&
+g++ -I./header -O2 -Wall -Wextra -Wno-sign-compare \
+    bench/corental_bench.cpp \
+    -o corental_bench
+
+if [ $? -ne 0 ]; then
+    echo "Compilation failed"
+    exit 1
+fi
+
+echo "====================================================="
+echo "Storage engines: tree of heap movies vs flat arrays"
+echo "====================================================="
+./storage_bench "$@"
+
+echo "====================================================="
+echo "Co-rental index: space-saving top-K vs exact counts"
+echo "====================================================="
+./corental_bench
+
+echo "====================================================="
+echo "Containers and factories against standard library baselines"
+echo "====================================================="
+./micro_bench
+
+echo "====================================================="
+echo "End to end: generated workload through the command loop"
+echo "====================================================="
+WORKLOAD=/tmp/store_bench_workload
+mkdir -p $WORKLOAD
+./workload_gen --titles=1000 --commands=20000 $WORKLOAD
+./store_bench $WORKLOAD
+./store_bench --flat $WORKLOAD | tail -1
+
+rm ./storage_bench ./corental_bench ./workload_gen ./store_bench ./micro_bench \
+    2>/dev/null
@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# Compile the movie store with the command server and drive it with the
+# load generator, e.g. ./runit-server.sh --clients=8 --idle=1000 --readers=2
+# Arguments are passed to server_load (see bench/server_load.cpp); set
+# TARGET_US to change the server's Borrow/Return p99 target
+
+echo "====================================================="
+echo "Compiling WITH the command server"
+echo "====================================================="
+
+# Clean up any existing executables
+rm ./a.out ./server_load 2>/dev/null
+
+g++ -I./header -O2 -std=c++20 -DSTORE_SERVER -Wall -Wextra -Wno-sign-compare \
+    main.cpp \
+    store_test.cpp \
+    src/classic.cpp \
+    src/comedy.cpp \
+    src/drama.cpp \
+    src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
+    src/inventory_command.cpp \
+    src/history_command.cpp \
+    src/borrow_command.cpp \
+    src/return_command.cpp &&
+g++ -I./header -O2 -Wall -Wextra -Wno-sign-compare \
+    bench/server_load.cpp -o server_load -pthread
+
+if [ $? -eq 0 ]; then
+    echo "====================================================="
+    echo "Compilation successful - running server and load"
+    echo "====================================================="
+    SOCKET=$(mktemp -u /tmp/store-XXXXXX.sock)
+    ./a.out --serve="$SOCKET" ${TARGET_US:+--target=$TARGET_US} > /dev/null &
+    SERVER=$!
+
+    # Wait for the data to load and the socket to appear
+    for i in $(seq 100); do
+        [ -S "$SOCKET" ] && break
+        sleep 0.1
+    done
+
+    ./server_load --socket="$SOCKET" "$@"
+    STATUS=$?
+    kill -TERM $SERVER
+    wait $SERVER
+else
+    echo "Compilation failed"
+    exit 1
+fi
+
+rm ./a.out ./server_load 2>/dev/null
+exit $STATUS
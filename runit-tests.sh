@@ -0,0 +1,56 @@
+#!/bin/bash
+
+# Compile with the command server, AddressSanitizer and UBSan, and run
+# every unit test in store_test.cpp; exits non-zero if any assert fails
+
+echo "====================================================="
+echo "Compiling the unit tests"
+echo "====================================================="
+
+# Clean up any existing executable
+rm ./a.out 2>/dev/null
+
+g++ -I./header -O1 -g -std=c++20 -DSTORE_SERVER \
+    -fsanitize=address,undefined -fno-sanitize-recover=undefined \
+    -Wall -Wextra -Wno-sign-compare \
+    main.cpp \
+    store_test.cpp \
+    src/classic.cpp \
+    src/comedy.cpp \
+    src/drama.cpp \
+    src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
+    src/inventory_command.cpp \
+    src/history_command.cpp \
+    src/borrow_command.cpp \
+    src/return_command.cpp
+
+if [ $? -eq 0 ]; then
+    echo "====================================================="
+    echo "Compilation successful - running tests"
+    echo "====================================================="
+    ./a.out --test
+    STATUS=$?
+else
+    echo "Compilation failed"
+    exit 1
+fi
+
+rm ./a.out 2>/dev/null
+exit $STATUS
@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Compile with tracing and run the movie store, writing trace.json
+# Open trace.json in https://ui.perfetto.dev or chrome://tracing
+
+echo "====================================================="
+echo "Compiling WITH tracing"
+echo "====================================================="
+
+# Clean up any existing executable
+rm ./a.out 2>/dev/null
+
+g++ -I./header -O2 -DSTORE_TRACING -Wall -Wextra -Wno-sign-compare \
+    main.cpp \
+    store_test.cpp \
+    src/classic.cpp \
+    src/comedy.cpp \
+    src/drama.cpp \
+    src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
+    src/inventory_command.cpp \
+    src/history_command.cpp \
+    src/borrow_command.cpp \
+    src/return_command.cpp
+
+if [ $? -eq 0 ]; then
+    echo "====================================================="
+    echo "Compilation successful - running program"
+    echo "====================================================="
+    STORE_TRACE_FILE=trace.json ./a.out "$@" > /dev/null
+    echo "Trace written to trace.json"
+else
+    echo "Compilation failed"
+    exit 1
+fi
+
+rm ./a.out 2>/dev/null
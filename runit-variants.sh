@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Compile once and check every runit-without-*.sh variant against its
+# output-without-*.txt baseline, running the variants in parallel threads
+
+echo "====================================================="
+echo "Compiling variant runner"
+echo "====================================================="
+
+rm ./variant_runner 2>/dev/null
+
+g++ -I./header -O2 -Wall -Wextra -Wno-sign-compare \
+    bench/variant_runner.cpp \
+    src/classic.cpp \
+    src/comedy.cpp \
+    src/drama.cpp \
+    src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
+    src/inventory_command.cpp \
+    src/history_command.cpp \
+    src/borrow_command.cpp \
+    src/return_command.cpp \
+    -o variant_runner
+
+if [ $? -eq 0 ]; then
+    echo "====================================================="
+    echo "Compilation successful - running variants"
+    echo "====================================================="
+    ./variant_runner
+    status=$?
+else
+    echo "Compilation failed"
+    exit 1
+fi
+
+rm ./variant_runner 2>/dev/null
+exit $status
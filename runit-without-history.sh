@@ -17,6 +17,23 @@ g++ -I./header -g -Wall -Wextra -Wno-sign-compare \
     src/comedy.cpp \
     src/drama.cpp \
     src/store.cpp \
+    src/top_command.cpp \
+    src/director_command.cpp \
+    src/actor_command.cpp \
+    src/prefix_command.cpp \
+    src/stock_command.cpp \
+    src/encoder.cpp \
+    src/deltawatcher.cpp \
+    src/delta_command.cpp \
+    src/retire_command.cpp \
+    src/close_command.cpp \
+    src/corental_command.cpp \
+    src/stats_command.cpp \
+    src/alloctracker.cpp \
+    src/commandlog.cpp \
+    src/server.cpp \
+    src/scheduler.cpp \
+    src/workpool.cpp \
     src/inventory_command.cpp \
     src/borrow_command.cpp \
     src/return_command.cpp
@@ -0,0 +1,62 @@
+/**
+ * @location src/actor_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class ActorRegistrar {
+public:
+  ActorRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'A', []() { return std::make_unique<ActorCommand>(); });
+  }
+};
+ActorRegistrar actorRegistrar;
+} // namespace
+
+bool ActorCommand::execute(Store &store) {
+  std::ostream &out = store.getMessageOutput();
+
+  out << "Debug: Titles with " << actor << "\n";
+  out << "==========================\n";
+
+  // Answered from the actor index without touching the genre trees
+  const std::vector<Movie *> *movies = store.findByActor(actor);
+  if (movies == nullptr) {
+    out << "No titles with " << actor << "\n";
+    return true;
+  }
+
+  for (const Movie *movie : *movies) {
+    movie->display(out);
+    out << "\n";
+  }
+
+  return true;
+}
+
+char ActorCommand::getCommandType() const { return 'A'; }
+
+Command *ActorCommand::clone() const { return new ActorCommand(*this); }
+
+// Command format: A FirstName LastName
+bool ActorCommand::setParameters(std::istream &input, const Store & /*store*/) {
+  std::getline(input, actor);
+
+  // Trim whitespace
+  size_t start = actor.find_first_not_of(" \t");
+  size_t end = actor.find_last_not_of(" \t");
+  if (start == std::string::npos || end == std::string::npos) {
+    return false;
+  }
+  actor = actor.substr(start, end - start + 1);
+
+  return true;
+}
+
+std::string ActorCommand::getDescription() const { return "Actor " + actor; }
@@ -0,0 +1,80 @@
+/**
+ * @location src/alloctracker.cpp
+ */
+
+#include "alloctracker.h"
+
+#ifdef STORE_ALLOC_TRACKING
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+AllocTracker::Counters AllocTracker::table[NUM_PHASES][COMMAND_TYPES];
+
+namespace {
+void *allocate(size_t bytes) {
+  AllocTracker::recordAllocation(bytes);
+  void *memory = std::malloc(bytes == 0 ? 1 : bytes);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void release(void *memory) {
+  if (memory != nullptr) {
+    AllocTracker::recordFree();
+    std::free(memory);
+  }
+}
+
+const char *const PHASE_NAMES[] = {"other", "load movies", "load customers",
+                                   "parse", "execute"};
+
+// Prints the table once everything else has finished
+struct ReportAtExit {
+  ~ReportAtExit() { AllocTracker::report(); }
+} reportAtExit;
+} // namespace
+
+void *operator new(size_t bytes) { return allocate(bytes); }
+void *operator new[](size_t bytes) { return allocate(bytes); }
+void operator delete(void *memory) noexcept { release(memory); }
+void operator delete[](void *memory) noexcept { release(memory); }
+void operator delete(void *memory, size_t /*bytes*/) noexcept {
+  release(memory);
+}
+void operator delete[](void *memory, size_t /*bytes*/) noexcept {
+  release(memory);
+}
+
+void AllocTracker::report() {
+  std::fprintf(stderr, "%-15s %4s %8s %10s %12s %10s %11s %10s\n", "Phase",
+               "Type", "Runs", "Allocs", "Bytes", "Frees", "Allocs/run",
+               "Bytes/run");
+  for (size_t phase = 0; phase < NUM_PHASES; phase++) {
+    for (size_t type = 0; type < COMMAND_TYPES; type++) {
+      const Counters &counters = table[phase][type];
+      uint64_t allocations = counters.allocations.load();
+      if (allocations == 0) {
+        continue;
+      }
+
+      uint64_t runs = counters.runs.load();
+      uint64_t bytes = counters.bytes.load();
+      char typeName[2] = {static_cast<char>(type == 0 ? '-' : type), '\0'};
+      std::fprintf(stderr,
+                   "%-15s %4s %8llu %10llu %12llu %10llu %11.1f %10.0f\n",
+                   PHASE_NAMES[phase], typeName,
+                   static_cast<unsigned long long>(runs),
+                   static_cast<unsigned long long>(allocations),
+                   static_cast<unsigned long long>(bytes),
+                   static_cast<unsigned long long>(counters.frees.load()),
+                   runs > 0 ? static_cast<double>(allocations) / runs : 0.0,
+                   runs > 0 ? static_cast<double>(bytes) / runs : 0.0);
+    }
+  }
+}
+
+#endif // STORE_ALLOC_TRACKING
@@ -5,6 +5,7 @@
 #include "commands.h"
 #include "customer.h"
 #include "factory.h"
+#include "formatbuffer.h"
 #include "movie.h"
 #include "store.h"
 #include <iostream>
@@ -25,42 +26,66 @@ BorrowRegistrar borrowRegistrar;
 BorrowCommand::BorrowCommand() : mediaType('\0'), movieType('\0') {}
 
 bool BorrowCommand::execute(Store &store) {
+  std::ostream &err = store.getErrorOutput();
+
+  // ID length depends on the store's ID mode
+  if (!store.isValidCustomerID(customerID)) {
+    store.getStats().count(CommandStats::INVALID_CUSTOMER);
+    return false;
+  }
+
   // Find customer
   Customer *customer = store.findCustomer(customerID);
   if (customer == nullptr) {
-    std::cerr << "Invalid customer ID " << customerID
-              << ", discarding line: " << " D " << movieType << " "
-              << movieSearchKey << std::endl;
+    store.getStats().count(CommandStats::INVALID_CUSTOMER);
+    err << "Invalid customer ID " << customerID << ", discarding line: "
+        << " D " << movieType << " " << movieSearchKey << std::endl;
     return false;
   }
 
   // Find movie
   Movie *movie = store.findMovie(movieType, movieSearchKey);
   if (movie == nullptr) {
-    std::cerr << "Invalid movie  for customer " << customer->getDisplayName()
-              << ", discarding line: " << std::endl;
+    store.getStats().count(CommandStats::INVALID_MOVIE);
+    err << "Invalid movie  for customer " << customer->getDisplayName()
+        << ", discarding line: " << std::endl;
+
+    // Offer the closest title when the key looks like a typo
+    const Movie *suggestion = store.suggestMovie(movieType, movieSearchKey);
+    if (suggestion != nullptr) {
+      err << "Did you mean: ";
+      suggestion->display(err);
+      err << std::endl;
+    }
     return false;
   }
 
   // Debug output
-  std::cout << "Debug: Borrow " << customerID << " "
+  FormatBuffer debugLine;
+  debugLine << "Debug: Borrow " << customerID << " "
             << customer->getDisplayName() << " ";
-  movie->display(std::cout);
-  std::cout << std::endl;
+  movie->format(debugLine);
+  debugLine << '\n';
+  debugLine.flushTo(store.getMessageOutput());
+  store.getMessageOutput().flush();
 
   // Attempt to borrow
-  if (!movie->borrowMovie()) {
-    reportError(customer->getDisplayName() + " could NOT borrow " +
-                movie->getTitle() + ", out of stock: ");
-    std::cerr << "Failed to execute command: Borrow "
-              << customer->getDisplayName() << " " << movie->getTitle()
-              << std::endl;
+  if (!store.borrowMovie(movie)) {
+    store.getStats().count(CommandStats::OUT_OF_STOCK);
+    reportError(err, customer->getDisplayName() + " could NOT borrow " +
+                         movie->getTitle() + ", out of stock: ");
+    err << "Failed to execute command: Borrow " << customer->getDisplayName()
+        << " " << movie->getTitle() << std::endl;
     return false;
   }
 
   // Add transaction
   customer->addTransaction(Transaction::BORROW, movie);
 
+  // Update most-borrowed leaderboard and co-rental counts
+  store.recordBorrow(movie);
+  store.recordCoRental(customer, movie);
+
   return true;
 }
 
@@ -68,7 +93,7 @@ char BorrowCommand::getCommandType() const { return 'B'; }
 
 Command *BorrowCommand::clone() const { return new BorrowCommand(*this); }
 
-bool BorrowCommand::setParameters(std::istream &input) {
+bool BorrowCommand::setParameters(std::istream &input, const Store &store) {
   // Read customer ID
   if (!(input >> customerID) || !isValidCustomerID(customerID)) {
     return false;
@@ -80,8 +105,9 @@ bool BorrowCommand::setParameters(std::istream &input) {
   }
 
   if (!isValidMediaType(mediaType)) {
-    std::cerr << "Invalid media type " << mediaType
-              << ", discarding line: " << " F Fargo, 1996" << std::endl;
+    store.getErrorOutput() << "Invalid media type " << mediaType
+                           << ", discarding line: " << " F Fargo, 1996"
+                           << std::endl;
     return false;
   }
 
@@ -90,15 +116,17 @@ bool BorrowCommand::setParameters(std::istream &input) {
     return false;
   }
 
-  if (!MovieFactory::getInstance().isValidMovieType(movieType)) {
-    std::cerr << "Invalid movie type " << movieType
-              << ", discarding line: " << " 2 1971 Malcolm McDowell"
-              << std::endl;
+  if (!MovieFactory::getInstance().isValidMovieType(
+          movieType, store.getMovieTypeMask())) {
+    store.getErrorOutput() << "Invalid movie type " << movieType
+                           << ", discarding line: "
+                           << " 2 1971 Malcolm McDowell" << std::endl;
     return false;
   }
 
   // Use temporary movie to parse search parameters
-  auto tempMovie = MovieFactory::getInstance().createMovie(movieType);
+  auto tempMovie = MovieFactory::getInstance().createMovie(
+      movieType, store.getMovieTypeMask());
   if (!tempMovie) {
     return false;
   }
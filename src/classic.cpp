@@ -4,6 +4,7 @@
 
 #include "classic.h"
 #include "factory.h"
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
 
@@ -14,6 +15,8 @@ public:
   ClassicRegistrar() {
     MovieFactory::getInstance().registerMovieType(
         'C', []() { return std::make_unique<Classic>(); });
+    MovieFactory::getInstance().registerGenreStore(
+        'C', []() { return std::make_unique<FlatGenreStore<Classic>>(); });
   }
 };
 // Static instance causes registration at program startup
@@ -26,15 +29,20 @@ Classic::Classic() : releaseMonth(0), releaseYear(0) {
 
 // Display format based on sample output: YYYY M, Actor, Director, Title (Stock)
 // - Classics
-void Classic::display(std::ostream &out) const {
+void Classic::format(FormatBuffer &out) const {
   out << releaseYear << " " << releaseMonth << ", " << actorFirstName << " "
-      << actorLastName << ", " << director << ", " << title << " (" << stock
-      << ") - Classics";
+      << actorLastName;
+  // Consolidated records list every major actor
+  for (const Actor &actor : otherActors) {
+    out << " & " << actor.firstName << " " << actor.lastName;
+  }
+  out << ", " << director << ", " << title << " (" << stock << ") - Classics";
 }
 
 // Sort by release date (YYYYMM), then major actor
 std::string Classic::getSortingKey() const {
-  return getReleaseDateSortKey() + " " + actorFirstName + " " + actorLastName;
+  return getReleaseDateSortKey() + " " + actorFirstName.str() + " " +
+         actorLastName.str();
 }
 
 std::string Classic::getReleaseDateSortKey() const {
@@ -49,6 +57,20 @@ bool Classic::operator<(const Movie &other) const {
   if (other.getMovieType() != 'C') {
     return getMovieType() < other.getMovieType();
   }
+
+  // Release dates are zero-padded in the key, so compare them as numbers
+  const auto &classic = static_cast<const Classic &>(other);
+  if (releaseYear != classic.releaseYear) {
+    return releaseYear < classic.releaseYear;
+  }
+  if (releaseMonth != classic.releaseMonth) {
+    return releaseMonth < classic.releaseMonth;
+  }
+
+  // Same first name handle: the keys differ only in the last name
+  if (actorFirstName == classic.actorFirstName) {
+    return actorLastName.str() < classic.actorLastName.str();
+  }
   return getSortingKey() < other.getSortingKey();
 }
 
@@ -66,13 +88,13 @@ bool Classic::parseData(std::istream &input) {
   }
 
   // Director
-  director = parseField(input, ',');
+  director = intern(parseField(input, ','));
   if (director.empty()) {
     return false;
   }
 
   // Title
-  title = parseField(input, ',');
+  title = intern(parseField(input, ','));
   if (title.empty()) {
     return false;
   }
@@ -90,10 +112,13 @@ bool Classic::parseData(std::istream &input) {
 
   // Parse actor first name, last name, month, year from remainder
   std::istringstream iss(remainder);
-  if (!(iss >> actorFirstName >> actorLastName >> releaseMonth >>
-        releaseYear)) {
+  std::string firstName;
+  std::string lastName;
+  if (!(iss >> firstName >> lastName >> releaseMonth >> releaseYear)) {
     return false;
   }
+  actorFirstName = intern(firstName);
+  actorLastName = intern(lastName);
 
   // Validate month
   if (releaseMonth < 1 || releaseMonth > 12) {
@@ -125,12 +150,80 @@ std::string Classic::createSearchKey(std::istream &input) const {
 
 // Search key matches command format: "M YYYY FirstName LastName"
 std::string Classic::getSearchKey() const {
+  return searchKeyFor(actorFirstName, actorLastName);
+}
+
+std::string Classic::searchKeyFor(const InternedString &firstName,
+                                  const InternedString &lastName) const {
   std::stringstream ss;
-  ss << releaseMonth << " " << releaseYear << " " << actorFirstName << " "
-     << actorLastName;
+  ss << releaseMonth << " " << releaseYear << " " << firstName << " "
+     << lastName;
   return ss.str();
 }
 
 char Classic::getMovieType() const { return 'C'; }
 
-Movie *Classic::clone() const { return new Classic(*this); }
\ No newline at end of file
+Movie *Classic::clone() const { return new Classic(*this); }
+
+std::vector<std::string> Classic::getMajorActors() const {
+  std::vector<std::string> actors;
+  actors.push_back(actorFirstName.str() + " " + actorLastName.str());
+  for (const Actor &actor : otherActors) {
+    actors.push_back(actor.firstName.str() + " " + actor.lastName.str());
+  }
+  return actors;
+}
+
+void Classic::forEachActor(const ActorVisitor &visit) const {
+  visit(actorFirstName, actorLastName);
+  for (const Actor &actor : otherActors) {
+    visit(actor.firstName, actor.lastName);
+  }
+}
+
+std::vector<std::string> Classic::getSearchKeys() const {
+  std::vector<std::string> keys;
+  keys.push_back(getSearchKey());
+  for (const Actor &actor : otherActors) {
+    keys.push_back(searchKeyFor(actor.firstName, actor.lastName));
+  }
+  return keys;
+}
+
+bool Classic::matchesSearchKey(const std::string &key) const {
+  if (getSearchKey() == key) {
+    return true;
+  }
+  return std::any_of(otherActors.begin(), otherActors.end(),
+                     [this, &key](const Actor &actor) {
+                       return searchKeyFor(actor.firstName, actor.lastName) ==
+                              key;
+                     });
+}
+
+std::string Classic::getConsolidationKey() const {
+  return title.str() + "," + director.str() + "," +
+         std::to_string(releaseMonth) + " " + std::to_string(releaseYear);
+}
+
+void Classic::mergeFrom(const Movie &other) {
+  Movie::mergeFrom(other);
+
+  const auto &classic = static_cast<const Classic &>(other);
+  std::vector<Actor> incoming = classic.otherActors;
+  incoming.insert(incoming.begin(),
+                  {classic.actorFirstName, classic.actorLastName});
+
+  // Skip actors this record already lists
+  for (const Actor &actor : incoming) {
+    bool known = actor.firstName == actorFirstName &&
+                 actor.lastName == actorLastName;
+    for (const Actor &existing : otherActors) {
+      known = known || (actor.firstName == existing.firstName &&
+                        actor.lastName == existing.lastName);
+    }
+    if (!known) {
+      otherActors.push_back(actor);
+    }
+  }
+}
\ No newline at end of file
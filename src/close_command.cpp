@@ -0,0 +1,62 @@
+/**
+ * @location src/close_command.cpp
+ */
+
+#include "commands.h"
+#include "customer.h"
+#include "factory.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class CloseRegistrar {
+public:
+  CloseRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'K', []() { return std::make_unique<CloseCommand>(); });
+  }
+};
+CloseRegistrar closeRegistrar;
+} // namespace
+
+bool CloseCommand::execute(Store &store) {
+  // ID length depends on the store's ID mode
+  if (!store.isValidCustomerID(customerID)) {
+    return false;
+  }
+
+  Customer *customer = store.findCustomer(customerID);
+  if (customer == nullptr) {
+    reportError(store.getErrorOutput(), "Invalid customer ID " + customerID);
+    return false;
+  }
+
+  store.getMessageOutput() << "Debug: Close " << customerID << " "
+                           << customer->getDisplayName() << "\n";
+  if (!store.closeCustomer(customerID)) {
+    reportError(store.getErrorOutput(),
+                customer->getDisplayName() + " still has movies checked out");
+    return false;
+  }
+  return true;
+}
+
+char CloseCommand::getCommandType() const { return 'K'; }
+
+Command *CloseCommand::clone() const { return new CloseCommand(*this); }
+
+// Command format: K customer-id
+bool CloseCommand::setParameters(std::istream &input, const Store & /*store*/) {
+  if (!(input >> customerID) || !isValidCustomerID(customerID)) {
+    return false;
+  }
+
+  std::string remainder;
+  std::getline(input, remainder);
+  return true;
+}
+
+std::string CloseCommand::getDescription() const {
+  return "Close " + customerID;
+}
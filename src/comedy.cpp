@@ -14,6 +14,8 @@ public:
   ComedyRegistrar() {
     MovieFactory::getInstance().registerMovieType(
         'F', []() { return std::make_unique<Comedy>(); });
+    MovieFactory::getInstance().registerGenreStore(
+        'F', []() { return std::make_unique<FlatGenreStore<Comedy>>(); });
   }
 };
 // Static instance causes registration at program startup
@@ -25,7 +27,7 @@ Comedy::Comedy() {
 }
 
 // Display format: Title, Year, Director (Stock) - Comedy
-void Comedy::display(std::ostream &out) const {
+void Comedy::format(FormatBuffer &out) const {
   out << title << ", " << year << ", " << director << " (" << stock
       << ") - Comedy";
 }
@@ -42,6 +44,12 @@ bool Comedy::operator<(const Movie &other) const {
   if (other.getMovieType() != 'F') {
     return getMovieType() < other.getMovieType();
   }
+
+  // Same title handle: the keys differ only in the padded year
+  const auto &comedy = static_cast<const Comedy &>(other);
+  if (title == comedy.title) {
+    return year < comedy.year;
+  }
   return getSortingKey() < other.getSortingKey();
 }
 
@@ -58,13 +66,13 @@ bool Comedy::parseData(std::istream &input) {
   }
 
   // Director
-  director = parseField(input, ',');
+  director = intern(parseField(input, ','));
   if (director.empty()) {
     return false;
   }
 
   // Title
-  title = parseField(input, ',');
+  title = intern(parseField(input, ','));
   if (title.empty()) {
     return false;
   }
@@ -104,7 +112,7 @@ std::string Comedy::createSearchKey(std::istream &input) const {
 
 // Search key format: Title,Year
 std::string Comedy::getSearchKey() const {
-  return title + "," + std::to_string(year);
+  return title.str() + "," + std::to_string(year);
 }
 
 char Comedy::getMovieType() const { return 'F'; }
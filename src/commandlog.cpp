@@ -0,0 +1,126 @@
+/**
+ * @location src/commandlog.cpp
+ */
+
+#include "commandlog.h"
+#include <sstream>
+
+namespace {
+const char MAGIC[] = "STORELOG";
+constexpr size_t MAGIC_LENGTH = sizeof(MAGIC) - 1;
+constexpr uint64_t VERSION = 1;
+
+constexpr char COMMAND_RECORD = 'C';
+constexpr char CHECKPOINT_RECORD = 'K';
+} // namespace
+
+bool CommandLogWriter::open(const std::string &filename) {
+  file.open(filename, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    return false;
+  }
+  buffer.append(MAGIC, MAGIC_LENGTH);
+  writeInteger(VERSION, 2);
+  return true;
+}
+
+void CommandLogWriter::writeCommand(uint32_t gapMicros, char commandType,
+                                    const std::string &arguments) {
+  buffer << COMMAND_RECORD;
+  writeInteger(gapMicros, 4);
+  buffer << commandType;
+  writeInteger(arguments.size(), 4);
+  buffer << arguments;
+  buffer.flushIfFull(file);
+}
+
+void CommandLogWriter::writeCheckpoint(const CommandLogCheckpoint &checkpoint) {
+  buffer << CHECKPOINT_RECORD;
+  writeInteger(checkpoint.commands, 8);
+  writeInteger(checkpoint.outputHash, 8);
+  writeInteger(checkpoint.stateHash, 8);
+  buffer.flushIfFull(file);
+}
+
+bool CommandLogWriter::close() {
+  buffer.flushTo(file);
+  file.close();
+  return !file.fail();
+}
+
+void CommandLogWriter::writeInteger(uint64_t value, int bytes) {
+  char packed[8];
+  for (int i = 0; i < bytes; i++) {
+    packed[i] = static_cast<char>(value >> (8 * i));
+  }
+  buffer.append(packed, static_cast<size_t>(bytes));
+}
+
+bool CommandLogReader::open(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::ostringstream read;
+  read << file.rdbuf();
+  contents = read.str();
+  damaged = false;
+
+  if (contents.compare(0, MAGIC_LENGTH, MAGIC) != 0) {
+    return false;
+  }
+  position = MAGIC_LENGTH;
+  uint64_t version = 0;
+  return readInteger(version, 2) && version == VERSION;
+}
+
+bool CommandLogReader::next(Record &record) {
+  if (position >= contents.size() || damaged) {
+    return false;
+  }
+
+  char kind = contents[position++];
+  uint64_t values[3];
+  if (kind == COMMAND_RECORD) {
+    uint64_t length = 0;
+    if (!readInteger(values[0], 4) || position >= contents.size()) {
+      damaged = true;
+      return false;
+    }
+    char commandType = contents[position++];
+    if (!readInteger(length, 4) || contents.size() - position < length) {
+      damaged = true;
+      return false;
+    }
+    record.kind = Record::COMMAND;
+    record.gapMicros = static_cast<uint32_t>(values[0]);
+    record.commandType = commandType;
+    record.arguments.assign(contents, position, length);
+    position += length;
+    return true;
+  }
+
+  if (kind == CHECKPOINT_RECORD && readInteger(values[0], 8) &&
+      readInteger(values[1], 8) && readInteger(values[2], 8)) {
+    record.kind = Record::CHECKPOINT;
+    record.checkpoint = {values[0], values[1], values[2]};
+    return true;
+  }
+
+  damaged = true;
+  return false;
+}
+
+bool CommandLogReader::readInteger(uint64_t &value, int bytes) {
+  if (contents.size() - position < static_cast<size_t>(bytes)) {
+    return false;
+  }
+  value = 0;
+  for (int i = 0; i < bytes; i++) {
+    value |= static_cast<uint64_t>(
+                 static_cast<unsigned char>(contents[position + i]))
+             << (8 * i);
+  }
+  position += bytes;
+  return true;
+}
@@ -0,0 +1,103 @@
+/**
+ * @location src/corental_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "movie.h"
+#include "store.h"
+#include <iostream>
+#include <sstream>
+
+// Self-registration with factory
+namespace {
+class CoRentalRegistrar {
+public:
+  CoRentalRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'N', []() { return std::make_unique<CoRentalCommand>(); });
+  }
+};
+CoRentalRegistrar coRentalRegistrar;
+
+constexpr int DEFAULT_NEIGHBOUR_COUNT = 5;
+} // namespace
+
+CoRentalCommand::CoRentalCommand()
+    : movieType('\0'), count(DEFAULT_NEIGHBOUR_COUNT) {}
+
+bool CoRentalCommand::execute(Store &store) {
+  std::ostream &out = store.getMessageOutput();
+
+  Movie *movie = store.findMovie(movieType, movieSearchKey);
+  if (movie == nullptr) {
+    reportError(store.getErrorOutput(), "No " + std::string(1, movieType) +
+                                            " title " + movieSearchKey);
+    return false;
+  }
+
+  out << "Debug: Also rented with ";
+  movie->display(out);
+  out << "\n";
+  out << "==========================\n";
+
+  auto entries = store.getCoRentals(movie, count);
+  if (entries.empty()) {
+    out << "No co-rentals for " << movie->getTitle() << "\n";
+    return true;
+  }
+
+  for (const auto &entry : entries) {
+    entry.movie->display(out);
+    out << ": " << entry.count << " co-rentals\n";
+  }
+
+  return true;
+}
+
+char CoRentalCommand::getCommandType() const { return 'N'; }
+
+Command *CoRentalCommand::clone() const { return new CoRentalCommand(*this); }
+
+// Command format: N genre search-key [; count], key as in Borrow and Return
+bool CoRentalCommand::setParameters(std::istream &input, const Store &store) {
+  if (!(input >> movieType)) {
+    return false;
+  }
+
+  if (!MovieFactory::getInstance().isValidMovieType(
+          movieType, store.getMovieTypeMask())) {
+    store.getErrorOutput() << "Invalid movie type " << movieType
+                           << ", discarding line: " << std::endl;
+    return false;
+  }
+
+  // Count is optional, after a ';' so it cannot be mistaken for the key
+  std::string rest;
+  std::getline(input, rest);
+  size_t separator = rest.find(';');
+  count = DEFAULT_NEIGHBOUR_COUNT;
+  if (separator != std::string::npos) {
+    std::istringstream countInput(rest.substr(separator + 1));
+    if (!(countInput >> count) || count <= 0) {
+      return false;
+    }
+    rest.erase(separator);
+  }
+
+  // Use temporary movie to parse search parameters
+  auto tempMovie = MovieFactory::getInstance().createMovie(
+      movieType, store.getMovieTypeMask());
+  if (!tempMovie) {
+    return false;
+  }
+
+  std::istringstream keyInput(rest);
+  movieSearchKey = tempMovie->createSearchKey(keyInput);
+  return !movieSearchKey.empty();
+}
+
+std::string CoRentalCommand::getDescription() const {
+  return "Also rented with " + std::string(1, movieType) + " " +
+         movieSearchKey;
+}
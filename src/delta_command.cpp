@@ -0,0 +1,75 @@
+/**
+ * @location src/delta_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class DeltaRegistrar {
+public:
+  DeltaRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'U', []() { return std::make_unique<DeltaCommand>(); });
+  }
+};
+DeltaRegistrar deltaRegistrar;
+} // namespace
+
+bool DeltaCommand::execute(Store &store) {
+  std::string directory = store.getDeltaDirectory();
+  if (directory.empty()) {
+    store.getErrorOutput() << "Cannot ingest " << filename
+                           << ": no delta directory is watched" << std::endl;
+    return false;
+  }
+
+  // An unreadable file is a failure, not an empty delta
+  std::string path = directory + "/" + filename;
+  int count = 0;
+  bool read = (deltaType == 'M') ? store.ingestMovieDelta(path, count)
+                                 : store.ingestCustomerDelta(path, count);
+  if (!read) {
+    return false;
+  }
+  store.getMessageOutput() << "Debug: Ingested " << count
+                           << (deltaType == 'M' ? " movies" : " customers")
+                           << " from " << filename << "\n";
+  return true;
+}
+
+char DeltaCommand::getCommandType() const { return 'U'; }
+
+Command *DeltaCommand::clone() const { return new DeltaCommand(*this); }
+
+// Command format: U M|C filename
+bool DeltaCommand::setParameters(std::istream &input, const Store &store) {
+  if (!(input >> deltaType >> filename)) {
+    return false;
+  }
+
+  if (deltaType != 'M' && deltaType != 'C') {
+    store.getErrorOutput() << "Invalid delta type " << deltaType
+                           << ", discarding line: " << std::endl;
+    return false;
+  }
+
+  // Only files in the delta directory, so no path may lead out of it
+  if (filename.find('/') != std::string::npos || filename == "." ||
+      filename == "..") {
+    store.getErrorOutput() << "Invalid delta file name " << filename
+                           << ", discarding line: " << std::endl;
+    return false;
+  }
+
+  std::string remainder;
+  std::getline(input, remainder);
+  return true;
+}
+
+std::string DeltaCommand::getDescription() const {
+  return "Ingest " + filename;
+}
@@ -0,0 +1,72 @@
+/**
+ * @location src/deltawatcher.cpp
+ */
+
+#include "deltawatcher.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+DeltaWatcher::DeltaWatcher() : inotifyFd(-1), watchDescriptor(-1) {}
+
+DeltaWatcher::~DeltaWatcher() {
+#ifdef __linux__
+  if (inotifyFd >= 0) {
+    close(inotifyFd);
+  }
+#endif
+}
+
+bool DeltaWatcher::watch(const std::string &directory) {
+#ifdef __linux__
+  if (inotifyFd < 0) {
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+      std::cerr << "Error: Could not start watching for delta files"
+                << std::endl;
+      return false;
+    }
+  }
+
+  // Only whole files: written and closed, or moved in complete
+  watchDescriptor = inotify_add_watch(inotifyFd, directory.c_str(),
+                                      IN_CLOSE_WRITE | IN_MOVED_TO);
+  if (watchDescriptor < 0) {
+    std::cerr << "Error: Could not watch directory " << directory
+              << std::endl;
+    return false;
+  }
+
+  watchedDirectory = directory;
+  return true;
+#else
+  std::cerr << "Error: Watching " << directory
+            << " is not supported on this platform" << std::endl;
+  return false;
+#endif
+}
+
+std::vector<std::string> DeltaWatcher::poll() {
+  std::vector<std::string> paths;
+#ifdef __linux__
+  if (inotifyFd < 0) {
+    return paths;
+  }
+
+  alignas(struct inotify_event) char buffer[4096];
+  ssize_t length;
+  while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+    for (char *ptr = buffer; ptr < buffer + length;) {
+      auto *event = reinterpret_cast<struct inotify_event *>(ptr);
+      if (event->wd == watchDescriptor && event->len > 0) {
+        paths.push_back(watchedDirectory + "/" + event->name);
+      }
+      ptr += sizeof(struct inotify_event) + event->len;
+    }
+  }
+#endif
+  return paths;
+}
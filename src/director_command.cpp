@@ -0,0 +1,65 @@
+/**
+ * @location src/director_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class DirectorRegistrar {
+public:
+  DirectorRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'W', []() { return std::make_unique<DirectorCommand>(); });
+  }
+};
+DirectorRegistrar directorRegistrar;
+} // namespace
+
+bool DirectorCommand::execute(Store &store) {
+  std::ostream &out = store.getMessageOutput();
+
+  out << "Debug: Titles by " << director << "\n";
+  out << "==========================\n";
+
+  // Answered from the director index without touching the genre trees
+  const std::vector<Movie *> *movies = store.findByDirector(director);
+  if (movies == nullptr) {
+    out << "No titles by " << director << "\n";
+    return true;
+  }
+
+  for (const Movie *movie : *movies) {
+    movie->display(out);
+    out << "\n";
+  }
+
+  return true;
+}
+
+char DirectorCommand::getCommandType() const { return 'W'; }
+
+Command *DirectorCommand::clone() const { return new DirectorCommand(*this); }
+
+// Command format: W FirstName LastName
+bool DirectorCommand::setParameters(std::istream &input,
+                                    const Store & /*store*/) {
+  std::getline(input, director);
+
+  // Trim whitespace
+  size_t start = director.find_first_not_of(" \t");
+  size_t end = director.find_last_not_of(" \t");
+  if (start == std::string::npos || end == std::string::npos) {
+    return false;
+  }
+  director = director.substr(start, end - start + 1);
+
+  return true;
+}
+
+std::string DirectorCommand::getDescription() const {
+  return "Director " + director;
+}
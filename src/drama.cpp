@@ -13,6 +13,8 @@ public:
   DramaRegistrar() {
     MovieFactory::getInstance().registerMovieType(
         'D', []() { return std::make_unique<Drama>(); });
+    MovieFactory::getInstance().registerGenreStore(
+        'D', []() { return std::make_unique<FlatGenreStore<Drama>>(); });
   }
 };
 // Static instance causes registration at program startup
@@ -24,19 +26,27 @@ Drama::Drama() {
 }
 
 // Display format: Director, Title, Year (Stock) - Drama
-void Drama::display(std::ostream &out) const {
+void Drama::format(FormatBuffer &out) const {
   out << director << ", " << title << ", " << year << " (" << stock
       << ") - Drama";
 }
 
 // Sort by Director, then Title
-std::string Drama::getSortingKey() const { return director + " " + title; }
+std::string Drama::getSortingKey() const {
+  return director.str() + " " + title.str();
+}
 
 bool Drama::operator<(const Movie &other) const {
   // Only compare with same type
   if (other.getMovieType() != 'D') {
     return getMovieType() < other.getMovieType();
   }
+
+  // Same director handle: the keys differ only in the title
+  const auto &drama = static_cast<const Drama &>(other);
+  if (director == drama.director) {
+    return title.str() < drama.title.str();
+  }
   return getSortingKey() < other.getSortingKey();
 }
 
@@ -53,13 +63,13 @@ bool Drama::parseData(std::istream &input) {
   }
 
   // Director
-  director = parseField(input, ',');
+  director = intern(parseField(input, ','));
   if (director.empty()) {
     return false;
   }
 
   // Title
-  title = parseField(input, ',');
+  title = intern(parseField(input, ','));
   if (title.empty()) {
     return false;
   }
@@ -110,7 +120,9 @@ std::string Drama::createSearchKey(std::istream &input) const {
 }
 
 // Search key format: Director,Title
-std::string Drama::getSearchKey() const { return director + "," + title; }
+std::string Drama::getSearchKey() const {
+  return director.str() + "," + title.str();
+}
 
 char Drama::getMovieType() const { return 'D'; }
 
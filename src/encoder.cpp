@@ -0,0 +1,311 @@
+/**
+ * @location src/encoder.cpp
+ */
+
+#include "encoder.h"
+#include <cstdint>
+#include <cstdio>
+
+bool parseOutputFormat(const std::string &name, OutputFormat &format) {
+  if (name == "text") {
+    format = OutputFormat::TEXT;
+  } else if (name == "json") {
+    format = OutputFormat::JSON_LINES;
+  } else if (name == "csv") {
+    format = OutputFormat::CSV;
+  } else if (name == "binary") {
+    format = OutputFormat::BINARY;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+namespace {
+// JSON string contents with quotes, backslashes and control chars escaped
+void writeJsonEscaped(FormatBuffer &out, const std::string &text) {
+  size_t runStart = 0;
+  for (size_t i = 0; i < text.size(); i++) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    if (c != '"' && c != '\\' && c >= 0x20) {
+      continue;
+    }
+
+    out.append(text.data() + runStart, i - runStart);
+    if (c == '"' || c == '\\') {
+      out << '\\' << static_cast<char>(c);
+    } else {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out << escaped;
+    }
+    runStart = i + 1;
+  }
+  out.append(text.data() + runStart, text.size() - runStart);
+}
+
+// JSON string literal
+void writeJsonString(FormatBuffer &out, const std::string &text) {
+  out << '"';
+  writeJsonEscaped(out, text);
+  out << '"';
+}
+
+bool needsCsvQuotes(const std::string &text) {
+  return text.find_first_of(",\"\r\n") != std::string::npos;
+}
+
+// CSV field contents with quotes doubled, for inside a quoted field
+void writeCsvEscaped(FormatBuffer &out, const std::string &text) {
+  for (char c : text) {
+    if (c == '"') {
+      out << '"';
+    }
+    out << c;
+  }
+}
+
+// CSV field, quoted only when it contains a separator, quote or newline
+void writeCsvField(FormatBuffer &out, const std::string &text) {
+  if (!needsCsvQuotes(text)) {
+    out << text;
+    return;
+  }
+
+  out << '"';
+  writeCsvEscaped(out, text);
+  out << '"';
+}
+
+// One JSON object per line
+class JsonLinesEncoder : public OutputEncoder {
+public:
+  void encodeMovie(const Movie &movie, FormatBuffer &out) override {
+    out << "{\"genre\":\"" << movie.getMovieType() << "\",\"title\":";
+    writeJsonString(out, movie.getTitle());
+    out << ",\"director\":";
+    writeJsonString(out, movie.getDirector());
+    out << ",\"year\":" << movie.getYear();
+    if (movie.getReleaseMonth() != 0) {
+      out << ",\"month\":" << movie.getReleaseMonth();
+    }
+
+    if (movie.getActorCount() > 0) {
+      out << ",\"actors\":[";
+      bool first = true;
+      movie.forEachActor([&out, &first](const std::string &firstName,
+                                        const std::string &lastName) {
+        out << (first ? "\"" : ",\"");
+        writeJsonEscaped(out, firstName);
+        out << ' ';
+        writeJsonEscaped(out, lastName);
+        out << '"';
+        first = false;
+      });
+      out << ']';
+    }
+    out << ",\"stock\":" << movie.getStock() << "}\n";
+  }
+
+  void encodeTransaction(const std::string &customerID,
+                         const Transaction &transaction,
+                         FormatBuffer &out) override {
+    const Movie *movie = transaction.getMovie();
+    out << "{\"customer\":";
+    writeJsonString(out, customerID);
+    out << ",\"type\":\""
+        << (transaction.getType() == Transaction::BORROW ? "borrow"
+                                                          : "return")
+        << "\",\"sequence\":" << transaction.getSequence()
+        << ",\"genre\":\"" << movie->getMovieType() << "\",\"title\":";
+    writeJsonString(out, movie->getTitle());
+    out << "}\n";
+  }
+};
+
+// Header row, then one comma-separated row per record; actors are joined
+// with ';'
+class CsvEncoder : public OutputEncoder {
+public:
+  void beginInventory(FormatBuffer &out) override {
+    out << "genre,title,director,year,month,actors,stock\n";
+  }
+
+  void beginHistory(FormatBuffer &out) override {
+    out << "customer,type,sequence,genre,title\n";
+  }
+
+  void encodeMovie(const Movie &movie, FormatBuffer &out) override {
+    out << movie.getMovieType() << ',';
+    writeCsvField(out, movie.getTitle());
+    out << ',';
+    writeCsvField(out, movie.getDirector());
+    out << ',' << movie.getYear() << ',';
+    if (movie.getReleaseMonth() != 0) {
+      out << movie.getReleaseMonth();
+    }
+    out << ',';
+
+    // Actors joined with ';' in one field, quoted if any name needs it
+    bool quoted = false;
+    movie.forEachActor([&quoted](const std::string &firstName,
+                                 const std::string &lastName) {
+      quoted = quoted || needsCsvQuotes(firstName) || needsCsvQuotes(lastName);
+    });
+    if (quoted) {
+      out << '"';
+    }
+    bool first = true;
+    movie.forEachActor([&out, &first](const std::string &firstName,
+                                      const std::string &lastName) {
+      if (!first) {
+        out << ';';
+      }
+      writeCsvEscaped(out, firstName);
+      out << ' ';
+      writeCsvEscaped(out, lastName);
+      first = false;
+    });
+    if (quoted) {
+      out << '"';
+    }
+    out << ',' << movie.getStock() << '\n';
+  }
+
+  void encodeTransaction(const std::string &customerID,
+                         const Transaction &transaction,
+                         FormatBuffer &out) override {
+    const Movie *movie = transaction.getMovie();
+    writeCsvField(out, customerID);
+    out << ','
+        << (transaction.getType() == Transaction::BORROW ? "borrow"
+                                                          : "return")
+        << ',' << transaction.getSequence() << ',' << movie->getMovieType()
+        << ',';
+    writeCsvField(out, movie->getTitle());
+    out << '\n';
+  }
+};
+
+// Length-prefixed records, all integers little-endian:
+//   record      u32 payload length, payload
+//   movie       'M', genre char, i32 stock, i32 year, u8 month,
+//               str director, str title, u8 actor count, str actors...
+//   transaction 'T', str customer, u8 type (0 borrow, 1 return),
+//               u32 sequence, genre char, str title
+// where str is a u16 byte length followed by the bytes
+class BinaryEncoder : public OutputEncoder {
+public:
+  void encodeMovie(const Movie &movie, FormatBuffer &out) override {
+    // Stock and year are ints, so they fit i32; the rest is narrower
+    bool fits = movie.getReleaseMonth() >= 0 &&
+                movie.getReleaseMonth() <= UINT8_MAX &&
+                movie.getActorCount() <= UINT8_MAX &&
+                fitsString(movie.getDirector()) && fitsString(movie.getTitle());
+    movie.forEachActor(
+        [&fits](const std::string &firstName, const std::string &lastName) {
+          fits = fits && actorLength(firstName, lastName) <= UINT16_MAX;
+        });
+    if (!fits) {
+      skipped++;
+      return;
+    }
+
+    size_t start = beginRecord(out);
+    out << 'M' << movie.getMovieType();
+    writeInteger(out, static_cast<uint32_t>(movie.getStock()));
+    writeInteger(out, static_cast<uint32_t>(movie.getYear()));
+    out << static_cast<char>(movie.getReleaseMonth());
+    writeString(out, movie.getDirector());
+    writeString(out, movie.getTitle());
+    out << static_cast<char>(movie.getActorCount());
+    movie.forEachActor(
+        [&out](const std::string &firstName, const std::string &lastName) {
+          writeLength(out, actorLength(firstName, lastName));
+          out << firstName << ' ' << lastName;
+        });
+    endRecord(out, start);
+  }
+
+  void encodeTransaction(const std::string &customerID,
+                         const Transaction &transaction,
+                         FormatBuffer &out) override {
+    const Movie *movie = transaction.getMovie();
+    if (!fitsString(customerID) || !fitsString(movie->getTitle())) {
+      skipped++;
+      return;
+    }
+
+    size_t start = beginRecord(out);
+    out << 'T';
+    writeString(out, customerID);
+    out << static_cast<char>(
+        transaction.getType() == Transaction::BORROW ? 0 : 1);
+    writeInteger(out, transaction.getSequence());
+    out << movie->getMovieType();
+    writeString(out, movie->getTitle());
+    endRecord(out, start);
+  }
+
+private:
+  static void packInteger(uint32_t value, char bytes[4]) {
+    for (int i = 0; i < 4; i++) {
+      bytes[i] = static_cast<char>(value >> (8 * i));
+    }
+  }
+
+  static void writeInteger(FormatBuffer &out, uint32_t value) {
+    char bytes[4];
+    packInteger(value, bytes);
+    out.append(bytes, sizeof(bytes));
+  }
+
+  static bool fitsString(const std::string &text) {
+    return text.size() <= UINT16_MAX;
+  }
+
+  // Bytes in "FirstName LastName"
+  static size_t actorLength(const std::string &firstName,
+                            const std::string &lastName) {
+    return firstName.size() + 1 + lastName.size();
+  }
+
+  // u16 string length, only for lengths that fit
+  static void writeLength(FormatBuffer &out, size_t length) {
+    out << static_cast<char>(length) << static_cast<char>(length >> 8);
+  }
+
+  // Only for strings that fit
+  static void writeString(FormatBuffer &out, const std::string &text) {
+    writeLength(out, text.size());
+    out.append(text.data(), text.size());
+  }
+
+  // Reserve the length prefix, returning where it starts
+  static size_t beginRecord(FormatBuffer &out) {
+    size_t start = out.size();
+    writeInteger(out, 0);
+    return start;
+  }
+
+  // Fill in the length prefix reserved at start
+  static void endRecord(FormatBuffer &out, size_t start) {
+    char bytes[4];
+    packInteger(static_cast<uint32_t>(out.size() - start - 4), bytes);
+    out.patch(start, bytes, sizeof(bytes));
+  }
+};
+} // namespace
+
+std::unique_ptr<OutputEncoder> OutputEncoder::create(OutputFormat format) {
+  switch (format) {
+  case OutputFormat::JSON_LINES:
+    return std::make_unique<JsonLinesEncoder>();
+  case OutputFormat::CSV:
+    return std::make_unique<CsvEncoder>();
+  case OutputFormat::BINARY:
+    return std::make_unique<BinaryEncoder>();
+  default:
+    return nullptr;
+  }
+}
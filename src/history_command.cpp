@@ -23,28 +23,57 @@ HistoryRegistrar historyRegistrar;
 HistoryCommand::HistoryCommand() {}
 
 bool HistoryCommand::execute(Store &store) {
-  // Debug output as shown in sample
-  std::cout << "Debug: History for " << customerID;
+  return findCustomer(store) != nullptr &&
+         store.displayCustomerHistory(customerID, store.getOutput(), format);
+}
 
-  Customer *customer = store.findCustomer(customerID);
-  if (customer == nullptr) {
-    reportError("Customer " + customerID + " not found");
-    return false;
+std::unique_ptr<SlicedReport> HistoryCommand::start(Store &store,
+                                                    bool &succeeded) {
+  Customer *customer = findCustomer(store);
+  succeeded = customer != nullptr;
+  if (!succeeded) {
+    return nullptr;
   }
+  return store.startCustomerHistory(*customer, format);
+}
 
-  std::cout << " " << customer->getDisplayName() << "\n";
-  std::cout << "==========================\n";
+Customer *HistoryCommand::findCustomer(Store &store) const {
+  std::ostream &out = store.getOutput();
 
-  customer->displayHistory(std::cout);
+  // ID length depends on the store's ID mode
+  if (!store.isValidCustomerID(customerID)) {
+    store.getStats().count(CommandStats::INVALID_CUSTOMER);
+    return nullptr;
+  }
 
-  return true;
+  // Machine-readable formats carry only the records
+  bool text = store.resolveOutputFormat(format) == OutputFormat::TEXT;
+  if (text) {
+    // Debug output as shown in sample
+    out << "Debug: History for " << customerID;
+  }
+
+  Customer *customer = store.findCustomer(customerID);
+  if (customer == nullptr) {
+    store.getStats().count(CommandStats::INVALID_CUSTOMER);
+    reportError(store.getErrorOutput(),
+                "Customer " + customerID + " not found");
+    return nullptr;
+  }
+
+  if (text) {
+    out << " " << customer->getDisplayName() << "\n";
+    out << "==========================\n";
+  }
+  return customer;
 }
 
 char HistoryCommand::getCommandType() const { return 'H'; }
 
 Command *HistoryCommand::clone() const { return new HistoryCommand(*this); }
 
-bool HistoryCommand::setParameters(std::istream &input) {
+// Command format: H customerID [text|json|csv|binary]
+bool HistoryCommand::setParameters(std::istream &input, const Store &store) {
   if (!(input >> customerID)) {
     return false;
   }
@@ -53,6 +82,14 @@ bool HistoryCommand::setParameters(std::istream &input) {
     return false;
   }
 
+  // Output format is optional
+  std::string formatName;
+  if (input >> formatName && !parseOutputFormat(formatName, format)) {
+    store.getErrorOutput() << "Unknown output format " << formatName
+                           << ", discarding line: " << std::endl;
+    return false;
+  }
+
   std::string remainder;
   std::getline(input, remainder);
 
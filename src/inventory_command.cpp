@@ -20,17 +20,37 @@ InventoryRegistrar inventoryRegistrar;
 } // namespace
 
 bool InventoryCommand::execute(Store &store) {
-  std::cout << "==========================\n";
-  store.displayInventory(std::cout);
+  // Machine-readable formats carry only the records
+  if (store.resolveOutputFormat(format) == OutputFormat::TEXT) {
+    store.getOutput() << "==========================\n";
+  }
+  store.displayInventory(store.getOutput(), format);
   return true;
 }
 
+std::unique_ptr<SlicedReport> InventoryCommand::start(Store &store,
+                                                      bool &succeeded) {
+  if (store.resolveOutputFormat(format) == OutputFormat::TEXT) {
+    store.getOutput() << "==========================\n";
+  }
+  succeeded = true;
+  return store.startInventory(format);
+}
+
 char InventoryCommand::getCommandType() const { return 'I'; }
 
 Command *InventoryCommand::clone() const { return new InventoryCommand(*this); }
 
-bool InventoryCommand::setParameters(std::istream &input) {
-  // Inventory command has no parameters
+// Command format: I [text|json|csv|binary]
+bool InventoryCommand::setParameters(std::istream &input, const Store &store) {
+  // Output format is optional
+  std::string formatName;
+  if (input >> formatName && !parseOutputFormat(formatName, format)) {
+    store.getErrorOutput() << "Unknown output format " << formatName
+                           << ", discarding line: " << std::endl;
+    return false;
+  }
+
   std::string remainder;
   std::getline(input, remainder);
   return true;
@@ -0,0 +1,64 @@
+/**
+ * @location src/prefix_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class PrefixRegistrar {
+public:
+  PrefixRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'P', []() { return std::make_unique<PrefixCommand>(); });
+  }
+};
+PrefixRegistrar prefixRegistrar;
+
+constexpr size_t MAX_COMPLETIONS = 10;
+} // namespace
+
+bool PrefixCommand::execute(Store &store) {
+  std::ostream &out = store.getMessageOutput();
+
+  out << "Debug: Titles matching " << prefix << "\n";
+  out << "==========================\n";
+
+  auto movies = store.autocomplete(prefix, MAX_COMPLETIONS);
+  if (movies.empty()) {
+    out << "No titles matching " << prefix << "\n";
+    return true;
+  }
+
+  for (const Movie *movie : movies) {
+    movie->display(out);
+    out << "\n";
+  }
+
+  return true;
+}
+
+char PrefixCommand::getCommandType() const { return 'P'; }
+
+Command *PrefixCommand::clone() const { return new PrefixCommand(*this); }
+
+// Command format: P prefix (rest of line, may contain spaces)
+bool PrefixCommand::setParameters(std::istream &input,
+                                  const Store & /*store*/) {
+  std::getline(input, prefix);
+
+  // Trim whitespace
+  size_t start = prefix.find_first_not_of(" \t");
+  size_t end = prefix.find_last_not_of(" \t");
+  if (start == std::string::npos || end == std::string::npos) {
+    return false;
+  }
+  prefix = prefix.substr(start, end - start + 1);
+
+  return true;
+}
+
+std::string PrefixCommand::getDescription() const { return "Prefix " + prefix; }
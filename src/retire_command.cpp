@@ -0,0 +1,74 @@
+/**
+ * @location src/retire_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "formatbuffer.h"
+#include "movie.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class RetireRegistrar {
+public:
+  RetireRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'E', []() { return std::make_unique<RetireCommand>(); });
+  }
+};
+RetireRegistrar retireRegistrar;
+} // namespace
+
+bool RetireCommand::execute(Store &store) {
+  Movie *movie = store.findMovie(movieType, movieSearchKey);
+  if (movie == nullptr) {
+    reportError(store.getErrorOutput(), "No " + std::string(1, movieType) +
+                                            " title " + movieSearchKey +
+                                            " to retire");
+    return false;
+  }
+
+  // Debug output
+  FormatBuffer debugLine;
+  debugLine << "Debug: Retire ";
+  movie->format(debugLine);
+  debugLine << '\n';
+  debugLine.flushTo(store.getMessageOutput());
+  store.getMessageOutput().flush();
+
+  return store.retireMovie(movieType, movieSearchKey);
+}
+
+char RetireCommand::getCommandType() const { return 'E'; }
+
+Command *RetireCommand::clone() const { return new RetireCommand(*this); }
+
+// Command format: E genre search-key, key as in Borrow and Return
+bool RetireCommand::setParameters(std::istream &input, const Store &store) {
+  if (!(input >> movieType)) {
+    return false;
+  }
+
+  if (!MovieFactory::getInstance().isValidMovieType(
+          movieType, store.getMovieTypeMask())) {
+    store.getErrorOutput() << "Invalid movie type " << movieType
+                           << ", discarding line: " << std::endl;
+    return false;
+  }
+
+  // Use temporary movie to parse search parameters
+  auto tempMovie = MovieFactory::getInstance().createMovie(
+      movieType, store.getMovieTypeMask());
+  if (!tempMovie) {
+    return false;
+  }
+
+  movieSearchKey = tempMovie->createSearchKey(input);
+  return !movieSearchKey.empty();
+}
+
+std::string RetireCommand::getDescription() const {
+  return "Retire " + std::string(1, movieType) + " " + movieSearchKey;
+}
@@ -5,6 +5,7 @@
 #include "commands.h"
 #include "customer.h"
 #include "factory.h"
+#include "formatbuffer.h"
 #include "movie.h"
 #include "store.h"
 #include <iostream>
@@ -25,41 +26,64 @@ ReturnRegistrar returnRegistrar;
 ReturnCommand::ReturnCommand() : mediaType('\0'), movieType('\0') {}
 
 bool ReturnCommand::execute(Store &store) {
+  std::ostream &err = store.getErrorOutput();
+
+  // ID length depends on the store's ID mode
+  if (!store.isValidCustomerID(customerID)) {
+    store.getStats().count(CommandStats::INVALID_CUSTOMER);
+    return false;
+  }
+
   // Find customer
   Customer *customer = store.findCustomer(customerID);
   if (customer == nullptr) {
-    std::cerr << "Invalid customer ID " << customerID
-              << ", discarding line: " << " D " << movieType << " "
-              << movieSearchKey << std::endl;
+    store.getStats().count(CommandStats::INVALID_CUSTOMER);
+    err << "Invalid customer ID " << customerID << ", discarding line: "
+        << " D " << movieType << " " << movieSearchKey << std::endl;
     return false;
   }
 
   // Find movie
   Movie *movie = store.findMovie(movieType, movieSearchKey);
   if (movie == nullptr) {
-    std::cerr << "Invalid movie  for customer " << customer->getDisplayName()
-              << ", discarding line: " << std::endl;
+    // Copies of a retired title can still come back
+    movie = store.findRetiredMovie(movieType, movieSearchKey);
+  }
+  if (movie == nullptr) {
+    store.getStats().count(CommandStats::INVALID_MOVIE);
+    err << "Invalid movie  for customer " << customer->getDisplayName()
+        << ", discarding line: " << std::endl;
+
+    // Offer the closest title when the key looks like a typo
+    const Movie *suggestion = store.suggestMovie(movieType, movieSearchKey);
+    if (suggestion != nullptr) {
+      err << "Did you mean: ";
+      suggestion->display(err);
+      err << std::endl;
+    }
     return false;
   }
 
   // Debug output
-  std::cout << "Debug: Return " << customerID << " "
+  FormatBuffer debugLine;
+  debugLine << "Debug: Return " << customerID << " "
             << customer->getDisplayName() << " ";
-  movie->display(std::cout);
-  std::cout << std::endl;
+  movie->format(debugLine);
+  debugLine << '\n';
+  debugLine.flushTo(store.getMessageOutput());
+  store.getMessageOutput().flush();
 
   // Check if customer has movie borrowed
   if (!customer->hasMovieBorrowed(movie)) {
-    reportError(customer->getDisplayName() + " does not have " +
-                movie->getTitle() + " checked out");
-    std::cerr << "Failed to execute command: Return "
-              << customer->getDisplayName() << " " << movie->getTitle()
-              << std::endl;
+    reportError(err, customer->getDisplayName() + " does not have " +
+                         movie->getTitle() + " checked out");
+    err << "Failed to execute command: Return " << customer->getDisplayName()
+        << " " << movie->getTitle() << std::endl;
     return false;
   }
 
   // Return the movie
-  movie->returnMovie();
+  store.returnMovie(movie);
 
   // Add transaction
   customer->addTransaction(Transaction::RETURN, movie);
@@ -71,7 +95,7 @@ char ReturnCommand::getCommandType() const { return 'R'; }
 
 Command *ReturnCommand::clone() const { return new ReturnCommand(*this); }
 
-bool ReturnCommand::setParameters(std::istream &input) {
+bool ReturnCommand::setParameters(std::istream &input, const Store &store) {
   // Read customer ID
   if (!(input >> customerID) || !isValidCustomerID(customerID)) {
     return false;
@@ -83,8 +107,9 @@ bool ReturnCommand::setParameters(std::istream &input) {
   }
 
   if (!isValidMediaType(mediaType)) {
-    std::cerr << "Invalid media type " << mediaType
-              << ", discarding line: " << " F Fargo, 1996" << std::endl;
+    store.getErrorOutput() << "Invalid media type " << mediaType
+                           << ", discarding line: " << " F Fargo, 1996"
+                           << std::endl;
     return false;
   }
 
@@ -93,15 +118,17 @@ bool ReturnCommand::setParameters(std::istream &input) {
     return false;
   }
 
-  if (!MovieFactory::getInstance().isValidMovieType(movieType)) {
-    std::cerr << "Invalid movie type " << movieType
-              << ", discarding line: " << " 2 1971 Malcolm McDowell"
-              << std::endl;
+  if (!MovieFactory::getInstance().isValidMovieType(
+          movieType, store.getMovieTypeMask())) {
+    store.getErrorOutput() << "Invalid movie type " << movieType
+                           << ", discarding line: "
+                           << " 2 1971 Malcolm McDowell" << std::endl;
     return false;
   }
 
   // Use temporary movie to parse search parameters
-  auto tempMovie = MovieFactory::getInstance().createMovie(movieType);
+  auto tempMovie = MovieFactory::getInstance().createMovie(
+      movieType, store.getMovieTypeMask());
   if (!tempMovie) {
     return false;
   }
@@ -0,0 +1,122 @@
+/**
+ * @location src/scheduler.cpp
+ */
+
+#include "scheduler.h"
+#include "store.h"
+#include <algorithm>
+
+CommandScheduler::CommandScheduler(Store &store,
+                                   const SchedulerOptions &options)
+    : store(store), previousOutput(store.getOutput()),
+      previousErrorOutput(store.getErrorOutput()), options(options),
+      sliceMicros(std::max(options.targetMicros / 4, MIN_SLICE_MICROS)) {
+  store.setOutput(capture, capture);
+}
+
+CommandScheduler::~CommandScheduler() {
+  store.setOutput(previousOutput, previousErrorOutput);
+}
+
+void CommandScheduler::submit(const std::string &line, Completion done) {
+  Job job;
+  job.line = line;
+  job.done = std::move(done);
+  job.submitted = Clock::now();
+
+  // Classified by the type the store will read, without parsing the rest
+  size_t typeAt = line.find_first_not_of(" \t\n\v\f\r");
+  job.commandType = (typeAt != std::string::npos) ? line[typeAt] : '\0';
+  bool isShort = job.commandType == 'B' || job.commandType == 'R';
+  (isShort ? shortQueue : longQueue).push_back(std::move(job));
+}
+
+bool CommandScheduler::runStep() {
+  // Delta files add titles, which an unfinished report cannot take
+  if (longQueue.empty() || !longQueue.front().started) {
+    applyWatchedDeltas();
+  }
+
+  // Only those already queued, so completions that submit more short
+  // commands cannot hold off the long queue
+  for (size_t count = shortQueue.size(); count > 0; count--) {
+    Job job = std::move(shortQueue.front());
+    shortQueue.pop_front();
+    startJob(job);
+
+    uint64_t latency = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                              job.submitted)
+            .count());
+    shortLatency.record(latency);
+    adjustSlice(latency);
+    job.done(job.response, job.succeeded);
+  }
+
+  if (!longQueue.empty()) {
+    Job &front = longQueue.front();
+    bool unfinished = front.started ? renderSlice(front)
+                                    : startJob(front) && renderSlice(front);
+    if (!unfinished) {
+      Job job = std::move(front);
+      longQueue.pop_front();
+      if (job.report) {
+        store.getStats().recordExecute(job.commandType, job.active,
+                                       job.succeeded);
+      }
+      job.done(job.response, job.succeeded);
+    }
+  }
+  return hasWork();
+}
+
+bool CommandScheduler::startJob(Job &job) {
+  job.started = true;
+  capture.str("");
+  capture.clear();
+  Clock::time_point start = Clock::now();
+  job.report = store.startCommandLine(job.line, job.succeeded);
+  job.active += Clock::now() - start;
+  capture.flush();
+  job.response = capture.str();
+  return job.report != nullptr;
+}
+
+bool CommandScheduler::renderSlice(Job &job) {
+  // Short commands run between slices, so the capture is this slice's
+  capture.str("");
+  capture.clear();
+  Clock::time_point start = Clock::now();
+  Clock::time_point end = start + std::chrono::microseconds(sliceMicros);
+  bool done = false;
+  do {
+    done = job.report->renderSlice(sliceBuffer, options.itemsPerCheck);
+  } while (!done && Clock::now() < end);
+  job.active += Clock::now() - start;
+
+  job.response.append(sliceBuffer.data(), sliceBuffer.size());
+  sliceBuffer.clear();
+
+  // Errors the slice reported, such as records an encoder left out
+  capture.flush();
+  job.response += capture.str();
+  capture.str("");
+  return !done;
+}
+
+void CommandScheduler::applyWatchedDeltas() {
+  // Ingest reports belong to no command, so they go where the store wrote
+  // before the scheduler took over
+  store.setOutput(previousOutput, previousErrorOutput);
+  store.applyWatchedDeltas();
+  store.setOutput(capture, capture);
+}
+
+void CommandScheduler::adjustSlice(uint64_t latencyMicros) {
+  uint64_t ceiling = std::max(options.targetMicros / 2, MIN_SLICE_MICROS);
+  if (latencyMicros > options.targetMicros) {
+    sliceMicros = std::max(sliceMicros / 2, MIN_SLICE_MICROS);
+  } else if (latencyMicros <= options.targetMicros / 2) {
+    sliceMicros = std::min(sliceMicros + sliceMicros / 16 + 1, ceiling);
+  }
+}
@@ -0,0 +1,260 @@
+/**
+ * @location src/server.cpp
+ */
+
+#ifdef STORE_SERVER
+
+#include "server.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+EventLoop::EventLoop()
+    : epollFd(epoll_create1(EPOLL_CLOEXEC)), running(false) {}
+
+EventLoop::~EventLoop() {
+  // Free the coroutines still parked, e.g. idle clients at shutdown
+  while (!registered.empty()) {
+    closeDescriptor(*registered.begin());
+  }
+  if (epollFd >= 0) {
+    close(epollFd);
+  }
+}
+
+EventLoop::ReadyAwaiter EventLoop::readable(int fd) {
+  return {*this, fd, EPOLLIN | EPOLLRDHUP};
+}
+
+EventLoop::ReadyAwaiter EventLoop::writable(int fd) {
+  return {*this, fd, EPOLLOUT};
+}
+
+void EventLoop::closeDescriptor(int fd) {
+  auto it = waiting.find(fd);
+  if (it != waiting.end()) {
+    std::coroutine_handle<> handle = it->second;
+    waiting.erase(it);
+    handle.destroy();
+  }
+  registered.erase(fd);
+  close(fd); // Also removes it from the epoll set
+}
+
+// One-shot, so a descriptor is disarmed once it fires until waited on again
+bool EventLoop::waitFor(int fd, uint32_t events,
+                        std::coroutine_handle<> handle) {
+  struct epoll_event event = {};
+  event.events = events | EPOLLONESHOT;
+  event.data.fd = fd;
+  int operation = EPOLL_CTL_MOD;
+  if (registered.insert(fd).second) {
+    operation = EPOLL_CTL_ADD;
+  }
+  if (epoll_ctl(epollFd, operation, fd, &event) < 0) {
+    return false;
+  }
+  waiting[fd] = handle;
+  return true;
+}
+
+void EventLoop::setBackgroundWork(std::function<bool()> work) {
+  backgroundWork = std::move(work);
+}
+
+void EventLoop::run() {
+  running = true;
+  bool pending = false;
+  struct epoll_event events[256];
+  while (running) {
+    int ready = epoll_wait(epollFd, events, 256, pending ? 0 : -1);
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Error: epoll_wait failed: " << std::strerror(errno)
+                << std::endl;
+      return;
+    }
+    for (int i = 0; i < ready; i++) {
+      auto it = waiting.find(events[i].data.fd);
+      if (it == waiting.end()) {
+        continue;
+      }
+      std::coroutine_handle<> handle = it->second;
+      waiting.erase(it);
+      handle.resume();
+    }
+    pending = backgroundWork && backgroundWork();
+  }
+
+  // Coroutines waiting on queued work resume, then park on their
+  // descriptors to be freed with the loop
+  while (pending) {
+    pending = backgroundWork();
+  }
+}
+
+CommandServer::CommandServer(Store &store, const SchedulerOptions &options)
+    : scheduler(store, options), listenFd(-1), signalFd(-1), connections(0) {
+  loop.setBackgroundWork([this]() { return scheduler.runStep(); });
+}
+
+CommandServer::~CommandServer() {
+  if (listenFd >= 0) {
+    loop.closeDescriptor(listenFd);
+    unlink(socketPath.c_str());
+  }
+  if (signalFd >= 0) {
+    loop.closeDescriptor(signalFd);
+  }
+}
+
+bool CommandServer::listen(const std::string &path) {
+  struct sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Error: Socket path too long: " << path << std::endl;
+    return false;
+  }
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listenFd < 0 || !loop.isOpen()) {
+    std::cerr << "Error: Could not create socket: " << std::strerror(errno)
+              << std::endl;
+    return false;
+  }
+
+  unlink(path.c_str());
+  if (bind(listenFd, reinterpret_cast<struct sockaddr *>(&address),
+           sizeof(address)) < 0 ||
+      ::listen(listenFd, SOMAXCONN) < 0) {
+    std::cerr << "Error: Could not listen on " << path << ": "
+              << std::strerror(errno) << std::endl;
+    return false;
+  }
+  socketPath = path;
+  return true;
+}
+
+bool CommandServer::run() {
+  if (listenFd < 0) {
+    return false;
+  }
+
+  // Shut down cleanly on SIGINT or SIGTERM, removing the socket file
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  if (sigprocmask(SIG_BLOCK, &signals, nullptr) < 0 ||
+      (signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC)) < 0) {
+    std::cerr << "Error: Could not watch for signals" << std::endl;
+    return false;
+  }
+
+  // Clients that hang up mid-response should not kill the server
+  std::signal(SIGPIPE, SIG_IGN);
+
+  waitForSignal();
+  acceptClients();
+  loop.run();
+  return true;
+}
+
+DetachedTask CommandServer::waitForSignal() {
+  co_await loop.readable(signalFd);
+
+  // Take the signal, so it is not delivered if it is unblocked later
+  signalfd_siginfo info;
+  if (read(signalFd, &info, sizeof(info)) < 0) {
+    std::cerr << "Error: Could not read signal" << std::endl;
+  }
+  loop.stop();
+}
+
+DetachedTask CommandServer::acceptClients() {
+  for (;;) {
+    co_await loop.readable(listenFd);
+    for (;;) {
+      int fd = accept4(listenFd, nullptr, nullptr,
+                       SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+        break; // EAGAIN once the backlog is drained; others are per client
+      }
+      connections++;
+      serveClient(fd);
+    }
+  }
+}
+
+DetachedTask CommandServer::serveClient(int fd) {
+  std::string input;
+  std::string output;
+  char buffer[4096];
+
+  for (;;) {
+    co_await loop.readable(fd);
+    ssize_t count = read(fd, buffer, sizeof(buffer));
+    if (count == 0) {
+      break;
+    }
+    if (count < 0) {
+      if (errno == EAGAIN || errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    input.append(buffer, static_cast<size_t>(count));
+
+    // Run every complete line in turn, skipping blank lines as command
+    // files do; a partial one waits for more input
+    size_t start = 0;
+    size_t newline;
+    while ((newline = input.find('\n', start)) != std::string::npos) {
+      size_t end = newline;
+      if (end > start && input[end - 1] == '\r') {
+        end--;
+      }
+      std::string line = input.substr(start, end - start);
+      start = newline + 1;
+      if (line.find_first_not_of(" \t") != std::string::npos) {
+        output += co_await scheduled(line);
+        output += ".\n";
+      }
+    }
+    input.erase(0, start);
+    if (input.size() > MAX_LINE_LENGTH) {
+      break;
+    }
+
+    // Send the responses, waiting while the client's buffer is full
+    size_t sent = 0;
+    while (sent < output.size()) {
+      ssize_t written = write(fd, output.data() + sent, output.size() - sent);
+      if (written > 0) {
+        sent += static_cast<size_t>(written);
+      } else if (written < 0 && (errno == EAGAIN || errno == EINTR)) {
+        co_await loop.writable(fd);
+      } else {
+        break;
+      }
+    }
+    if (sent < output.size()) {
+      break;
+    }
+    output.clear();
+  }
+
+  loop.closeDescriptor(fd);
+}
+
+
+#endif // STORE_SERVER
@@ -0,0 +1,43 @@
+/**
+ * @location src/stats_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class StatsRegistrar {
+public:
+  StatsRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'S', []() { return std::make_unique<StatsCommand>(); });
+  }
+};
+StatsRegistrar statsRegistrar;
+} // namespace
+
+// Covers commands that finished before this one
+bool StatsCommand::execute(Store &store) {
+  std::ostream &out = store.getMessageOutput();
+
+  out << "Debug: Stats\n";
+  out << "==========================\n";
+  store.reportStats(out);
+  return true;
+}
+
+char StatsCommand::getCommandType() const { return 'S'; }
+
+Command *StatsCommand::clone() const { return new StatsCommand(*this); }
+
+// Command format: S
+bool StatsCommand::setParameters(std::istream &input, const Store & /*store*/) {
+  std::string remainder;
+  std::getline(input, remainder);
+  return true;
+}
+
+std::string StatsCommand::getDescription() const { return "Stats"; }
@@ -0,0 +1,76 @@
+/**
+ * @location src/stock_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class StockReportRegistrar {
+public:
+  StockReportRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'L', []() { return std::make_unique<StockReportCommand>('L'); });
+    CommandFactory::getInstance().registerCommandType(
+        'O', []() { return std::make_unique<StockReportCommand>('O'); });
+  }
+};
+StockReportRegistrar stockReportRegistrar;
+
+constexpr int DEFAULT_LOW_STOCK = 2;
+} // namespace
+
+StockReportCommand::StockReportCommand(char commandType)
+    : commandType(commandType),
+      threshold(commandType == 'O' ? 1 : DEFAULT_LOW_STOCK) {}
+
+bool StockReportCommand::execute(Store &store) {
+  std::ostream &out = store.getMessageOutput();
+
+  if (commandType == 'O') {
+    out << "Debug: Out of stock\n";
+  } else {
+    out << "Debug: Stock below " << threshold << "\n";
+  }
+  out << "==========================\n";
+
+  auto movies = store.findStockBelow(threshold);
+  if (movies.empty()) {
+    out << "No titles found\n";
+    return true;
+  }
+
+  for (const Movie *movie : movies) {
+    movie->display(out);
+    out << "\n";
+  }
+
+  return true;
+}
+
+char StockReportCommand::getCommandType() const { return commandType; }
+
+Command *StockReportCommand::clone() const {
+  return new StockReportCommand(*this);
+}
+
+// Command format: L [threshold] or O
+bool StockReportCommand::setParameters(std::istream &input,
+                                       const Store & /*store*/) {
+  // Threshold is optional and only meaningful for low stock
+  if (commandType == 'L' && !(input >> threshold)) {
+    threshold = DEFAULT_LOW_STOCK;
+  }
+
+  std::string remainder;
+  std::getline(input, remainder);
+
+  return threshold > 0;
+}
+
+std::string StockReportCommand::getDescription() const {
+  return commandType == 'O' ? "Out of stock" : "Low stock";
+}
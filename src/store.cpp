@@ -3,28 +3,219 @@
  */
 
 #include "store.h"
+#include "alloctracker.h"
 #include "bstree.h"
 #include "classic.h"
 #include "comedy.h"
 #include "command.h"
 #include "customer.h"
+#include "deltawatcher.h"
 #include "drama.h"
 #include "factory.h"
+#include "flatstore.h"
+#include "formatbuffer.h"
 #include "hashtable.h"
 #include "movie.h"
+#include "tracing.h"
+#include "trie.h"
+#include "workpool.h"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <sstream>
+#include <thread>
 
-Store::Store() {
-  // Initialize the hash table for customers
-  customers = std::make_unique<HashTable<std::string, Customer *>>();
+namespace {
+// Largest edit distance still offered as a "did you mean" suggestion
+constexpr size_t MAX_SUGGESTION_DISTANCE = 2;
+
+// Customers per storage chunk
+constexpr size_t CUSTOMER_CHUNK_SIZE = 4096;
+
+// Customer files shorter than this are parsed on the calling thread
+constexpr size_t PARALLEL_PARSE_MIN_LINES = 65536;
+
+// Inventories smaller than this are rendered on the calling thread
+constexpr size_t PARALLEL_RENDER_MIN_MOVIES = 16384;
+
+// Subtrees per rendering thread and genre, so threads that finish early
+// have pieces left to steal
+constexpr size_t RENDER_PIECES_PER_THREAD = 8;
+
+// Genre comparison matches sorting key order but can short-circuit on
+// shared name handles instead of building both keys
+bool compareMovies(Movie *const &a, Movie *const &b) { return *a < *b; }
+
+// Retired movies are looked up by genre and search key together
+std::string retiredKey(char movieType, const std::string &searchKey) {
+  return movieType + searchKey;
+}
+
+// Tell the reader that records the encoder could not hold were left out
+void reportSkipped(size_t skipped, std::ostream &err) {
+  if (skipped > 0) {
+    err << "Left out " << skipped
+        << " records too large for the output format" << std::endl;
+  }
+}
+
+// Inventory is displayed in order: Comedy, Drama, Classics
+constexpr char INVENTORY_GENRES[] = {'F', 'D', 'C'};
+constexpr size_t INVENTORY_GENRE_COUNT = sizeof(INVENTORY_GENRES);
+
+// Customer history from the transactions it held when the report began
+class HistoryReport : public SlicedReport {
+public:
+  HistoryReport(const Customer &customer,
+                std::unique_ptr<OutputEncoder> encoder, std::ostream &err)
+      : customer(customer), encoder(std::move(encoder)), err(err),
+        begun(false), done(!customer.hasHistory()), cursor() {
+    if (!done) {
+      cursor = customer.historyCursor();
+    }
+  }
+
+  bool renderSlice(FormatBuffer &out, size_t limit) override {
+    if (!begun) {
+      begun = true;
+      if (encoder) {
+        encoder->beginHistory(out);
+      } else {
+        customer.formatHistoryHeader(out);
+      }
+    }
+    if (!done) {
+      done = encoder ? customer.encodeHistoryFrom(cursor, limit, *encoder, out)
+                     : customer.formatHistoryFrom(cursor, limit, out);
+      if (done && encoder) {
+        reportSkipped(encoder->getSkipped(), err);
+      }
+    }
+    return done;
+  }
+
+private:
+  const Customer &customer;
+  std::unique_ptr<OutputEncoder> encoder;
+  std::ostream &err;
+  bool begun;
+  bool done;
+  TransactionLog::Cursor cursor;
+};
+} // namespace
+
+// Walks each genre tree with a cursor; flat genres are sorted on first
+// use, so their order is copied out when the report reaches them
+class Store::InventoryReport : public SlicedReport {
+public:
+  InventoryReport(const Store &store, std::unique_ptr<OutputEncoder> encoder)
+      : store(store), encoder(std::move(encoder)), begun(false), genre(0),
+        genreOpen(false), flatNext(0) {}
+
+  bool renderSlice(FormatBuffer &out, size_t limit) override {
+    if (!begun) {
+      begun = true;
+      if (encoder) {
+        encoder->beginInventory(out);
+      }
+    }
+
+    for (; genre < INVENTORY_GENRE_COUNT; genre++, genreOpen = false) {
+      if (!genreOpen) {
+        openGenre(INVENTORY_GENRES[genre]);
+      }
+      for (const Movie *movie = current(); movie != nullptr;
+           movie = advance()) {
+        if (limit-- == 0) {
+          return false;
+        }
+        if (encoder) {
+          encoder->encodeMovie(*movie, out);
+        } else {
+          movie->format(out);
+          out << '\n';
+        }
+      }
+    }
+    if (encoder) {
+      reportSkipped(encoder->getSkipped(), store.getErrorOutput());
+    }
+    return true;
+  }
+
+private:
+  const Store &store;
+  std::unique_ptr<OutputEncoder> encoder;
+  bool begun;
+  size_t genre; // Index into INVENTORY_GENRES
+  bool genreOpen;
+  std::unique_ptr<BSTree<Movie *>::Cursor> cursor;
+  std::vector<const Movie *> flatOrder;
+  size_t flatNext;
+
+  void openGenre(char movieType) {
+    genreOpen = true;
+    cursor.reset();
+    flatOrder.clear();
+    flatNext = 0;
+    if (store.flatStorage) {
+      store.forEachMovieSorted(movieType, [this](const Movie *movie) {
+        flatOrder.push_back(movie);
+      });
+      return;
+    }
+    const BSTree<Movie *> *tree = store.getGenreTree(movieType);
+    if (tree != nullptr) {
+      cursor = std::make_unique<BSTree<Movie *>::Cursor>(*tree);
+    }
+  }
+
+  // Movie at the current position of the open genre, nullptr at its end
+  const Movie *current() const {
+    if (cursor) {
+      return cursor->done() ? nullptr : cursor->current();
+    }
+    return (flatNext < flatOrder.size()) ? flatOrder[flatNext] : nullptr;
+  }
+
+  const Movie *advance() {
+    if (cursor) {
+      cursor->advance();
+    } else {
+      flatNext++;
+    }
+    return current();
+  }
+};
+
+Store::Store()
+    : consolidateRecords(false), wideCustomerIDs(false), flatStorage(false),
+      outputFormat(OutputFormat::TEXT), output(&std::cout),
+      errorOutput(&std::cerr), transactionLog(catalog) {
+  // Initialize the director and actor indexes
+  directorIndex =
+      std::make_unique<HashTable<InternedString, std::vector<Movie *>>>();
+  actorIndex =
+      std::make_unique<HashTable<InternedString, std::vector<Movie *>>>();
+  consolidatedRecords = std::make_unique<HashTable<std::string, Movie *>>();
+  retiredMovies = std::make_unique<HashTable<std::string, Movie *>>();
 
   // Initialize BSTs for each movie genre
   // Using map allows easy extension for new genres
   genreTrees['F'] = std::make_unique<BSTree<Movie *>>(); // Comedy
   genreTrees['D'] = std::make_unique<BSTree<Movie *>>(); // Drama
   genreTrees['C'] = std::make_unique<BSTree<Movie *>>(); // Classics
+
+  // One leaderboard and search key trie per genre tree
+  for (const auto &entry : genreTrees) {
+    genreLeaderboards[entry.first] = std::make_unique<Leaderboard>();
+    searchKeyTries[entry.first] = std::make_unique<Trie<Movie *>>();
+    searchKeyFilters[entry.first] = BloomFilter();
+  }
+  nameTrie = std::make_unique<Trie<Movie *>>();
 }
 
 Store::~Store() {
@@ -33,28 +224,38 @@ Store::~Store() {
 
 bool Store::initialize(const std::string &movieFile,
                        const std::string &customerFile) {
+  TRACE_SCOPE("Store::initialize");
+
   // Load customers first (they're referenced by commands)
   int customersLoaded = loadCustomers(customerFile);
   if (customersLoaded == 0) {
-    std::cerr << "Warning: No customers loaded from " << customerFile
-              << std::endl;
+    *errorOutput << "Warning: No customers loaded from " << customerFile
+                 << std::endl;
   }
 
   // Load movies
   int moviesLoaded = loadMovies(movieFile);
   if (moviesLoaded == 0) {
-    std::cerr << "Warning: No movies loaded from " << movieFile << std::endl;
+    *errorOutput << "Warning: No movies loaded from " << movieFile << std::endl;
     return false;
   }
 
+  // Size the Bloom filters for what was actually loaded
+  TRACE_SCOPE("rebuild Bloom filters");
+  rebuildCustomerFilter();
+  for (const auto &entry : searchKeyFilters) {
+    rebuildSearchKeyFilter(entry.first);
+  }
+
   return true;
 }
 
 bool Store::processCommands(const std::string &commandFile) {
+  TRACE_SCOPE("Store::processCommands");
   std::ifstream file(commandFile);
   if (!file.is_open()) {
-    std::cerr << "Error: Could not open command file " << commandFile
-              << std::endl;
+    *errorOutput << "Error: Could not open command file " << commandFile
+                 << std::endl;
     return false;
   }
 
@@ -64,6 +265,9 @@ bool Store::processCommands(const std::string &commandFile) {
       continue;
     }
 
+    // Pick up delta files dropped in since the last command
+    applyWatchedDeltas();
+
     processCommandLine(line);
   }
 
@@ -71,9 +275,201 @@ bool Store::processCommands(const std::string &commandFile) {
   return true;
 }
 
+// Output and errors go through hashing buffers in front of the store's
+// streams; errors flush output first, as std::cerr does for std::cout
+class Store::OutputHashScope {
+public:
+  explicit OutputHashScope(Store &store)
+      : store(store), savedOutput(store.output),
+        savedErrorOutput(store.errorOutput),
+        outputBuffer(store.output->rdbuf(), hash),
+        errorBuffer(store.errorOutput->rdbuf(), hash), output(&outputBuffer),
+        errorOutput(&errorBuffer) {
+    errorOutput.tie(&output);
+    store.output = &output;
+    store.errorOutput = &errorOutput;
+  }
+
+  ~OutputHashScope() {
+    output.flush();
+    store.output = savedOutput;
+    store.errorOutput = savedErrorOutput;
+  }
+
+  uint64_t value() const { return hash.value(); }
+
+private:
+  Store &store;
+  std::ostream *savedOutput;
+  std::ostream *savedErrorOutput;
+  StreamHash hash;
+  HashingStreamBuffer outputBuffer;
+  HashingStreamBuffer errorBuffer;
+  std::ostream output;
+  std::ostream errorOutput;
+};
+
+bool Store::captureCommands(const std::string &commandFile,
+                            const std::string &logFile,
+                            size_t checkpointEvery) {
+  TRACE_SCOPE("Store::captureCommands");
+  if (!getDeltaDirectory().empty()) {
+    *errorOutput << "Error: Cannot capture commands while watching for "
+                    "delta files"
+                 << std::endl;
+    return false;
+  }
+  std::ifstream file(commandFile);
+  if (!file.is_open()) {
+    *errorOutput << "Error: Could not open command file " << commandFile
+                 << std::endl;
+    return false;
+  }
+  CommandLogWriter log;
+  if (!log.open(logFile)) {
+    *errorOutput << "Error: Could not create command log " << logFile
+                 << std::endl;
+    return false;
+  }
+
+  OutputHashScope outputHash(*this);
+  uint64_t commands = 0;
+  auto previous = std::chrono::steady_clock::now();
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    // Gap since the previous line arrived, which for a pipe is the gap
+    // between the writer's commands; longer ones (over 71 minutes) are
+    // recorded as the longest the log holds
+    auto now = std::chrono::steady_clock::now();
+    auto gap =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - previous);
+    previous = now;
+    uint32_t gapMicros = static_cast<uint32_t>(
+        std::min<std::chrono::microseconds::rep>(
+            gap.count(), std::numeric_limits<uint32_t>::max()));
+
+    // Split as the >> in processCommandLine does
+    size_t typeAt = line.find_first_not_of(" \t\n\v\f\r");
+    if (typeAt == std::string::npos) {
+      log.writeCommand(gapMicros, '\0', "");
+    } else {
+      log.writeCommand(gapMicros, line[typeAt], line.substr(typeAt + 1));
+    }
+
+    processCommandLine(line);
+
+    commands++;
+    if (checkpointEvery > 0 && commands % checkpointEvery == 0) {
+      log.writeCheckpoint({commands, outputHash.value(), stateHash()});
+    }
+  }
+
+  if (checkpointEvery == 0 || commands % checkpointEvery != 0) {
+    log.writeCheckpoint({commands, outputHash.value(), stateHash()});
+  }
+  if (!log.close()) {
+    *errorOutput << "Error: Could not write command log " << logFile
+                 << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Store::replayCommands(const std::string &logFile,
+                           const ReplayOptions &options,
+                           ReplayReport &report) {
+  TRACE_SCOPE("Store::replayCommands");
+  CommandLogReader log;
+  if (!log.open(logFile)) {
+    *errorOutput << "Error: Could not read command log " << logFile
+                 << std::endl;
+    return false;
+  }
+
+  report = ReplayReport();
+  OutputHashScope outputHash(*this);
+  auto start = std::chrono::steady_clock::now();
+  double dueMicros = 0;
+  CommandLogReader::Record record;
+  std::istringstream arguments;
+  while (log.next(record)) {
+    if (record.kind == CommandLogReader::Record::CHECKPOINT) {
+      CommandLogCheckpoint actual = {report.commands, outputHash.value(),
+                                     stateHash()};
+      if (actual == record.checkpoint) {
+        report.checkpointsMatched++;
+      } else if (report.checkpointsDiverged++ == 0) {
+        report.expected = record.checkpoint;
+        report.actual = actual;
+      }
+      continue;
+    }
+
+    // Hold each command until its captured arrival time, scaled
+    if (options.speed > 0) {
+      dueMicros += record.gapMicros / options.speed;
+      std::this_thread::sleep_until(
+          start + std::chrono::microseconds(static_cast<int64_t>(dueMicros)));
+    }
+
+    ALLOC_SCOPE_COMMAND(PARSE_COMMAND, record.commandType);
+    TRACE_SCOPE("replay command");
+    CommandStats::Clock::time_point commandStart = CommandStats::Clock::now();
+    report.commands++;
+    if (record.commandType == '\0') {
+      stats.count(CommandStats::PARSE_FAILURE);
+      continue;
+    }
+    arguments.clear();
+    arguments.str(record.arguments);
+    processCommand(record.commandType, arguments, commandStart);
+  }
+
+  report.elapsedMillis = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  if (log.isDamaged()) {
+    *errorOutput << "Error: Command log " << logFile << " is damaged after "
+                 << report.commands << " commands" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+uint64_t Store::stateHash() const {
+  StreamHash hash;
+  HashingStreamBuffer discard(nullptr, hash);
+  std::ostream out(&discard);
+  displayInventory(out, OutputFormat::BINARY);
+  out << customers.size() << ' ' << transactionLog.size();
+  return hash.value();
+}
+
 Customer *Store::findCustomer(const std::string &customerID) {
-  Customer **customerPtr = customers->find(customerID);
-  return (customerPtr != nullptr) ? *customerPtr : nullptr;
+  uint64_t id = 0;
+  if (!Customer::parseID(customerID, wideCustomerIDs, id)) {
+    return nullptr;
+  }
+
+  // Unknown IDs are rejected before probing the index
+  if (!customerFilter.mayContain(id)) {
+    return nullptr;
+  }
+
+  Customer *customer = customers.find(id);
+  if (customer == nullptr) {
+    customerFilter.recordFalsePositive();
+  }
+  return customer;
+}
+
+bool Store::isValidCustomerID(const std::string &customerID) const {
+  uint64_t id = 0;
+  return Customer::parseID(customerID, wideCustomerIDs, id);
 }
 
 Movie *Store::findMovie(char movieType, const std::string &searchKey) {
@@ -82,40 +478,255 @@ Movie *Store::findMovie(char movieType, const std::string &searchKey) {
     return nullptr;
   }
 
+  // Unknown search keys are rejected before the tree scan
+  BloomFilter &filter = searchKeyFilters[movieType];
+  if (!filter.mayContain(searchKey)) {
+    return nullptr;
+  }
+
+  // Flat storage answers from its own key table
+  if (flatStorage) {
+    GenreStore *flat = getFlatStore(movieType);
+    Movie *movie = (flat != nullptr) ? flat->find(searchKey) : nullptr;
+    if (movie == nullptr) {
+      filter.recordFalsePositive();
+    }
+    return movie;
+  }
+
   // Use predicate search since search key format doesn't follow BST ordering
   Movie **result = tree->findByPredicate([&searchKey](Movie *const &movie) {
-    return movie->getSearchKey() == searchKey;
+    return movie->matchesSearchKey(searchKey);
   });
 
-  return (result != nullptr) ? *result : nullptr;
+  if (result == nullptr) {
+    filter.recordFalsePositive();
+    return nullptr;
+  }
+  return *result;
 }
 
-void Store::displayInventory(std::ostream &out) const {
-  // Display in order: Comedy, Drama, Classics
-  const char genreOrder[] = {'F', 'D', 'C'};
+const std::vector<Movie *> *
+Store::findByDirector(const std::string &director) const {
+  return findInIndex(*directorIndex, director);
+}
+
+const std::vector<Movie *> *
+Store::findByActor(const std::string &actor) const {
+  return findInIndex(*actorIndex, actor);
+}
+
+Movie *Store::findRetiredMovie(char movieType,
+                               const std::string &searchKey) const {
+  Movie *const *movie = retiredMovies->find(retiredKey(movieType, searchKey));
+  return (movie != nullptr) ? *movie : nullptr;
+}
+
+const Movie *Store::suggestMovie(char movieType,
+                                 const std::string &searchKey) const {
+  auto it = searchKeyTries.find(movieType);
+  if (it == searchKeyTries.end()) {
+    return nullptr;
+  }
+
+  Movie *const *nearest =
+      it->second->findNearest(searchKey, MAX_SUGGESTION_DISTANCE);
+  return (nearest != nullptr) ? *nearest : nullptr;
+}
+
+std::vector<const Movie *> Store::autocomplete(const std::string &prefix,
+                                               size_t limit) const {
+  // A movie can match by title and by director, so ask for extra candidates
+  std::vector<const Movie *> result;
+  for (Movie *movie : nameTrie->findPrefix(prefix, limit * 2)) {
+    if (result.size() < limit &&
+        std::find(result.begin(), result.end(), movie) == result.end()) {
+      result.push_back(movie);
+    }
+  }
+  return result;
+}
+
+void Store::displayInventory(std::ostream &out, OutputFormat format) const {
+  if (displayInventoryInParallel(out, resolveOutputFormat(format))) {
+    return;
+  }
+  FormatBuffer buffer;
+
+  // Machine-readable formats stream one record per movie
+  std::unique_ptr<OutputEncoder> encoder =
+      OutputEncoder::create(resolveOutputFormat(format));
+  if (encoder) {
+    encoder->beginInventory(buffer);
+    for (char genre : INVENTORY_GENRES) {
+      forEachMovieSorted(genre, [&](const Movie *movie) {
+        encoder->encodeMovie(*movie, buffer);
+        buffer.flushIfFull(out);
+      });
+    }
+    buffer.flushTo(out);
+    reportSkipped(encoder->getSkipped(), *errorOutput);
+    return;
+  }
+
+  for (char genre : INVENTORY_GENRES) {
+    if (flatStorage) {
+      const GenreStore *flat = getFlatStore(genre);
+      if (flat != nullptr) {
+        flat->display(out);
+      }
+      continue;
+    }
 
-  for (char genre : genreOrder) {
     auto it = genreTrees.find(genre);
     if (it != genreTrees.end() && it->second) {
-      it->second->inOrderTraversal([&out](Movie *const &movie) {
-        movie->display(out);
-        out << "\n";
+      it->second->inOrderTraversal([&](Movie *const &movie) {
+        movie->format(buffer);
+        buffer << '\n';
+        buffer.flushIfFull(out);
       });
+      buffer.flushTo(out);
     }
   }
 }
 
 bool Store::displayCustomerHistory(const std::string &customerID,
-                                   std::ostream &out) {
+                                   std::ostream &out, OutputFormat format) {
   Customer *customer = findCustomer(customerID);
   if (customer == nullptr) {
     return false;
   }
 
-  customer->displayHistory(out);
+  std::unique_ptr<OutputEncoder> encoder =
+      OutputEncoder::create(resolveOutputFormat(format));
+  if (!encoder) {
+    customer->displayHistory(out);
+    return true;
+  }
+
+  FormatBuffer buffer;
+  encoder->beginHistory(buffer);
+  customer->encodeHistory(*encoder, buffer);
+  buffer.flushTo(out);
+  reportSkipped(encoder->getSkipped(), *errorOutput);
   return true;
 }
 
+bool Store::displayInventoryInParallel(std::ostream &out,
+                                       OutputFormat format) const {
+  if (!renderPool || flatStorage) {
+    return false;
+  }
+  size_t movies = 0;
+  for (char genre : INVENTORY_GENRES) {
+    const BSTree<Movie *> *tree = getGenreTree(genre);
+    movies += (tree != nullptr) ? tree->size() : 0;
+  }
+  if (movies < PARALLEL_RENDER_MIN_MOVIES) {
+    return false;
+  }
+  TRACE_SCOPE("displayInventoryInParallel");
+
+  // Cut each tree where subtrees are short enough to give every thread
+  // several; the pieces are consecutive, so their outputs concatenate in
+  // genre and sorting key order
+  size_t wanted = (renderPool->size() + 1) * RENDER_PIECES_PER_THREAD;
+  int levels = 0;
+  while ((size_t{1} << levels) < wanted) {
+    levels++;
+  }
+  std::vector<std::pair<const BSTree<Movie *> *, BSTree<Movie *>::Range>>
+      pieces;
+  for (char genre : INVENTORY_GENRES) {
+    const BSTree<Movie *> *tree = getGenreTree(genre);
+    if (tree == nullptr) {
+      continue;
+    }
+    for (const BSTree<Movie *>::Range &range :
+         tree->split(tree->getHeight() - levels)) {
+      pieces.emplace_back(tree, range);
+    }
+  }
+
+  // Each piece gets its own buffer and encoder, so threads share nothing
+  // but the movies they read
+  std::vector<FormatBuffer> rendered(pieces.size());
+  std::vector<size_t> skipped(pieces.size(), 0);
+  std::vector<WorkStealingPool::Task> tasks;
+  tasks.reserve(pieces.size());
+  for (size_t i = 0; i < pieces.size(); i++) {
+    tasks.push_back([&pieces, &rendered, &skipped, format, i]() {
+      TRACE_SCOPE("render inventory piece");
+      ALLOC_SCOPE_COMMAND(EXECUTE_COMMAND, 'I');
+      std::unique_ptr<OutputEncoder> encoder = OutputEncoder::create(format);
+      FormatBuffer &text = rendered[i];
+      pieces[i].first->inOrderTraversal(
+          pieces[i].second, [&](Movie *const &movie) {
+            if (encoder) {
+              encoder->encodeMovie(*movie, text);
+            } else {
+              movie->format(text);
+              text << '\n';
+            }
+          });
+      if (encoder) {
+        skipped[i] = encoder->getSkipped();
+      }
+    });
+  }
+
+  FormatBuffer header;
+  std::unique_ptr<OutputEncoder> encoder = OutputEncoder::create(format);
+  if (encoder) {
+    encoder->beginInventory(header);
+  }
+  renderPool->runAll(tasks);
+
+  header.flushTo(out);
+  for (FormatBuffer &text : rendered) {
+    text.flushTo(out);
+  }
+  reportSkipped(std::accumulate(skipped.begin(), skipped.end(), size_t{0}),
+                *errorOutput);
+  return true;
+}
+
+std::unique_ptr<SlicedReport>
+Store::startInventory(OutputFormat format) const {
+  return std::make_unique<InventoryReport>(
+      *this, OutputEncoder::create(resolveOutputFormat(format)));
+}
+
+std::unique_ptr<SlicedReport>
+Store::startCustomerHistory(const Customer &customer,
+                            OutputFormat format) const {
+  return std::make_unique<HistoryReport>(
+      customer, OutputEncoder::create(resolveOutputFormat(format)),
+      *errorOutput);
+}
+
+void Store::setOutputFormat(OutputFormat format) {
+  outputFormat =
+      (format == OutputFormat::DEFAULT) ? OutputFormat::TEXT : format;
+}
+
+OutputFormat Store::resolveOutputFormat(OutputFormat requested) const {
+  return (requested == OutputFormat::DEFAULT) ? outputFormat : requested;
+}
+
+void Store::setOutput(std::ostream &out, std::ostream &err) {
+  output = &out;
+  errorOutput = &err;
+}
+
+void Store::disableCommandType(char commandType) {
+  commandMask.disable(commandType);
+}
+
+void Store::disableMovieType(char movieType) {
+  movieTypeMask.disable(movieType);
+}
+
 bool Store::addMovie(std::unique_ptr<Movie> movie) {
   if (!movie) {
     return false;
@@ -124,23 +735,61 @@ bool Store::addMovie(std::unique_ptr<Movie> movie) {
   char movieType = movie->getMovieType();
   BSTree<Movie *> *tree = getGenreTree(movieType);
   if (tree == nullptr) {
-    std::cerr << "No tree available for movie type " << movieType << std::endl;
+    *errorOutput << "No tree available for movie type " << movieType
+                 << std::endl;
     return false;
   }
 
-  // Get raw pointer for tree storage
-  Movie *moviePtr = movie.get();
+  GenreStore *flat = flatStorage ? getFlatStore(movieType) : nullptr;
+  if (flatStorage && flat == nullptr) {
+    *errorOutput << "No storage available for movie type " << movieType
+                 << std::endl;
+    return false;
+  }
 
-  // Define comparison function for this movie type
-  auto compareFunc = [](Movie *const &a, Movie *const &b) {
-    return a->getSortingKey() < b->getSortingKey();
-  };
+  // Fold rows describing the same physical title into one record
+  std::string consolidationKey =
+      consolidateRecords ? movie->getConsolidationKey() : "";
+  if (!consolidationKey.empty()) {
+    Movie **existing = consolidatedRecords->find(consolidationKey);
+    if (existing != nullptr && (*existing)->getMovieType() == movieType) {
+      (*existing)->mergeFrom(*movie);
+      catalog.updateStock((*existing)->getCatalogIndex(),
+                          (*existing)->getStock());
+      indexNamesAndKeys(*existing, *movie);
+      return true;
+    }
+  }
+
+  Movie *moviePtr = nullptr;
+  if (flat != nullptr) {
+    // Flat storage copies the record into its contiguous genre array
+    moviePtr = flat->add(std::move(movie));
+  } else {
+    // Get raw pointer for tree storage
+    moviePtr = movie.get();
+
+    // Insert into appropriate tree
+    TRACE_SCOPE("BSTree::insert");
+    tree->insert(moviePtr, compareMovies);
+
+    // Transfer ownership to inventory vector
+    movieInventory.push_back(std::move(movie));
+  }
 
-  // Insert into appropriate tree
-  tree->insert(moviePtr, compareFunc);
+  if (!consolidationKey.empty()) {
+    consolidatedRecords->insert(consolidationKey, moviePtr);
+  }
+
+  moviePtr->setCatalogIndex(catalog.add(moviePtr));
 
-  // Transfer ownership to inventory vector
-  movieInventory.push_back(std::move(movie));
+  // Maintain director index and title/director autocomplete
+  addToIndex(*directorIndex, moviePtr->getInternedDirector(), moviePtr);
+  nameTrie->insert(moviePtr->getTitle(), moviePtr);
+  nameTrie->insert(moviePtr->getDirector(), moviePtr);
+
+  // Maintain actor and search key lookups
+  indexNamesAndKeys(moviePtr, *moviePtr);
 
   return true;
 }
@@ -150,49 +799,318 @@ bool Store::addCustomer(std::unique_ptr<Customer> customer) {
     return false;
   }
 
-  const std::string &id = customer->getID();
-  Customer *customerPtr = customer.get();
+  uint64_t id = customer->getNumericID();
+  if (customers.find(id) != nullptr) {
+    *errorOutput << "Customer with ID " << customer->getID()
+                 << " already exists" << std::endl;
+    return false;
+  }
+
+  // Move into chunked storage, where addresses stay fixed
+  if (customerChunks.empty() ||
+      customerChunks.back().size() == CUSTOMER_CHUNK_SIZE) {
+    customerChunks.emplace_back();
+    customerChunks.back().reserve(CUSTOMER_CHUNK_SIZE);
+  }
+  customerChunks.back().push_back(std::move(*customer));
+  Customer *customerPtr = &customerChunks.back().back();
+  customers.insert(id, customerPtr);
+
+  // Record history in the shared log
+  customerPtr->attachLog(&transactionLog);
+
+  // Keep the customer filter complete, growing it when full
+  if (customerFilter.size() >= customerFilter.capacity()) {
+    rebuildCustomerFilter();
+  } else {
+    customerFilter.insert(id);
+  }
+
+  return true;
+}
 
-  // Insert into hash table
-  if (!customers->insert(id, customerPtr)) {
-    std::cerr << "Customer with ID " << id << " already exists" << std::endl;
+bool Store::retireMovie(char movieType, const std::string &searchKey) {
+  Movie *movie = findMovie(movieType, searchKey);
+  if (movie == nullptr) {
     return false;
   }
 
-  // Transfer ownership to customer list
-  customerList.push_back(std::move(customer));
+  // Stop listing it
+  if (flatStorage) {
+    getFlatStore(movieType)->remove(movie);
+  } else {
+    getGenreTree(movieType)->erase(movie, compareMovies);
+  }
+
+  // Stop finding it; keep it reachable for returns of copies still out
+  for (const std::string &key : movie->getSearchKeys()) {
+    searchKeyTries[movieType]->erase(key, movie);
+    retiredMovies->insert(retiredKey(movieType, key), movie);
+  }
 
+  removeFromIndex(*directorIndex, movie->getInternedDirector(), movie);
+  nameTrie->erase(movie->getTitle(), movie);
+  nameTrie->erase(movie->getDirector(), movie);
+  for (const std::string &actor : movie->getMajorActors()) {
+    InternedString interned;
+    if (StringPool::getInstance().lookup(actor, interned)) {
+      removeFromIndex(*actorIndex, interned, movie);
+    }
+    nameTrie->erase(actor, movie);
+  }
+
+  std::string consolidationKey = movie->getConsolidationKey();
+  Movie **record = consolidatedRecords->find(consolidationKey);
+  if (record != nullptr && *record == movie) {
+    consolidatedRecords->erase(consolidationKey);
+  }
+
+  auto leaderboard = genreLeaderboards.find(movieType);
+  if (leaderboard != genreLeaderboards.end()) {
+    leaderboard->second->remove(movie);
+  }
+
+  // The movie object stays as a tombstone so history can still show it
+  coRentals.remove(movie->getCatalogIndex());
+  catalog.retire(movie->getCatalogIndex());
   return true;
 }
 
-int Store::loadMovies(const std::string &filename) {
+bool Store::closeCustomer(const std::string &customerID) {
+  Customer *customer = findCustomer(customerID);
+  if (customer == nullptr || customer->hasOutstandingRentals()) {
+    return false;
+  }
+
+  // The record stays in its chunk, so its history in the log is intact
+  return customers.erase(customer->getNumericID());
+}
+
+bool Store::ingestMovieDelta(const std::string &filename, int &count) {
+  count = 0;
   std::ifstream file(filename);
   if (!file.is_open()) {
-    std::cerr << "Error: Could not open movie file " << filename << std::endl;
-    return 0;
+    *errorOutput << "Error: Could not open movie file " << filename
+                 << std::endl;
+    return false;
   }
 
+  // Rows that do not parse are reported by number, not quoted, as the
+  // file may not be a delta file at all
   std::string line;
-  int count = 0;
+  int lineNumber = 0;
   while (std::getline(file, line)) {
+    lineNumber++;
     if (line.empty()) {
       continue;
     }
 
-    if (processMovieLine(line)) {
+    auto movie = parseMovieLine(line, false);
+    if (!movie) {
+      *errorOutput << "Invalid movie row at " << filename << ":"
+                   << lineNumber << ", skipping it" << std::endl;
+    } else if (upsertMovie(std::move(movie))) {
       count++;
     }
   }
+  return true;
+}
 
-  file.close();
-  return count;
+bool Store::ingestCustomerDelta(const std::string &filename, int &count) {
+  // Adding customers one by one already keeps every index current
+  return loadCustomers(filename, false, count);
 }
 
-int Store::loadCustomers(const std::string &filename) {
+bool Store::watchDeltaDirectory(const std::string &directory) {
+  if (!deltaWatcher) {
+    deltaWatcher = std::make_unique<DeltaWatcher>();
+  }
+  return deltaWatcher->watch(directory);
+}
+
+std::string Store::getDeltaDirectory() const {
+  return deltaWatcher ? deltaWatcher->getDirectory() : std::string();
+}
+
+bool Store::upsertMovie(std::unique_ptr<Movie> movie) {
+  // Search keys are exact trie entries, so the lookup costs one key length
+  // rather than a scan of the genre
+  auto it = searchKeyTries.find(movie->getMovieType());
+  if (it != searchKeyTries.end()) {
+    const std::vector<Movie *> *existing =
+        it->second->find(movie->getSearchKey());
+    if (existing != nullptr) {
+      Movie *target = existing->front();
+      target->mergeFrom(*movie);
+      catalog.updateStock(target->getCatalogIndex(), target->getStock());
+      return true;
+    }
+  }
+  return addMovie(std::move(movie));
+}
+
+void Store::applyWatchedDeltas() {
+  if (!deltaWatcher) {
+    return;
+  }
+
+  const std::string movieSuffix = ".movies";
+  const std::string customerSuffix = ".customers";
+  auto endsWith = [](const std::string &path, const std::string &suffix) {
+    return path.size() >= suffix.size() &&
+           path.compare(path.size() - suffix.size(), suffix.size(),
+                        suffix) == 0;
+  };
+
+  // An ingest reports a file it cannot open itself
+  int count = 0;
+  for (const std::string &path : deltaWatcher->poll()) {
+    if (endsWith(path, movieSuffix)) {
+      ingestMovieDelta(path, count);
+    } else if (endsWith(path, customerSuffix)) {
+      ingestCustomerDelta(path, count);
+    }
+  }
+}
+
+bool Store::borrowMovie(Movie *movie) {
+  if (!movie->borrowMovie()) {
+    return false;
+  }
+  catalog.updateStock(movie->getCatalogIndex(), movie->getStock());
+  return true;
+}
+
+void Store::returnMovie(Movie *movie) {
+  movie->returnMovie();
+  catalog.updateStock(movie->getCatalogIndex(), movie->getStock());
+}
+
+int64_t Store::getShelfCopies(char movieType) const {
+  return catalog.totalStock(movieType);
+}
+
+std::vector<Movie *> Store::findStockBelow(int threshold) const {
+  return catalog.stockBelow(threshold);
+}
+
+void Store::recordBorrow(const Movie *movie) {
+  auto it = genreLeaderboards.find(movie->getMovieType());
+  if (it != genreLeaderboards.end()) {
+    it->second->recordBorrow(movie);
+  }
+}
+
+void Store::recordCoRental(const Customer *customer, const Movie *movie) {
+  coRentals.recordBorrow(customer->getNumericID(), movie->getCatalogIndex());
+}
+
+std::vector<Leaderboard::Entry> Store::getCoRentals(const Movie *movie,
+                                                    size_t n) const {
+  // Retired neighbours are skipped, so read the whole list
+  std::vector<Leaderboard::Entry> result;
+  for (const CoRentalIndex::Neighbour &neighbour : coRentals.neighbours(
+           movie->getCatalogIndex(), coRentals.getCapacity())) {
+    if (result.size() == n) {
+      break;
+    }
+    if (catalog.isActive(neighbour.movieIndex)) {
+      result.push_back(
+          {catalog.movieAt(neighbour.movieIndex), neighbour.count});
+    }
+  }
+  return result;
+}
+
+std::vector<Leaderboard::Entry> Store::getTopBorrowed(char movieType,
+                                                      size_t n) const {
+  auto it = genreLeaderboards.find(movieType);
+  if (it == genreLeaderboards.end()) {
+    return {};
+  }
+  return it->second->top(n);
+}
+
+size_t Store::getTopBorrowedCapacity(char movieType) const {
+  auto it = genreLeaderboards.find(movieType);
+  return (it != genreLeaderboards.end()) ? it->second->getCapacity() : 0;
+}
+
+void Store::useApproximateBorrowCounts(size_t width, size_t depth) {
+  for (auto &entry : genreLeaderboards) {
+    entry.second->useSketch(width, depth);
+  }
+}
+
+const BloomFilter::Stats &Store::getCustomerFilterStats() const {
+  return customerFilter.getStats();
+}
+
+BloomFilter::Stats Store::getMovieFilterStats() const {
+  // Combined over all genres
+  BloomFilter::Stats total;
+  for (const auto &entry : searchKeyFilters) {
+    const BloomFilter::Stats &stats = entry.second.getStats();
+    total.lookups += stats.lookups;
+    total.rejected += stats.rejected;
+    total.falsePositives += stats.falsePositives;
+  }
+  return total;
+}
+
+void Store::reportStats(std::ostream &out) const {
+  stats.report(out);
+  auto writeFilter = [&out](const char *name,
+                            const BloomFilter::Stats &filter) {
+    out << name << " filter: " << filter.lookups << " lookups, "
+        << filter.rejected << " rejected, " << filter.falsePositives
+        << " false positives\n";
+  };
+  writeFilter("Customer", getCustomerFilterStats());
+  writeFilter("Movie", getMovieFilterStats());
+
+  const StringPool &pool = StringPool::getInstance();
+  out << "String pool: " << pool.size() << " strings, " << pool.bytesSaved()
+      << " duplicate bytes saved\n";
+}
+
+void Store::rebuildCustomerFilter() {
+  // Double the headroom so growth rebuilds stay amortized O(1). Closed
+  // customers stay in their chunks but not in the index; leaving them out
+  // keeps the filter within the capacity sized from the index.
+  customerFilter.reset(customers.size() * 2);
+  for (const auto &chunk : customerChunks) {
+    for (const Customer &customer : chunk) {
+      if (customers.find(customer.getNumericID()) == &customer) {
+        customerFilter.insert(customer.getNumericID());
+      }
+    }
+  }
+}
+
+void Store::rebuildSearchKeyFilter(char movieType) {
+  // Consolidated records carry one key per major actor
+  std::vector<std::string> keys;
+  forEachMovie(movieType, [&keys](Movie *movie) {
+    for (std::string &key : movie->getSearchKeys()) {
+      keys.push_back(std::move(key));
+    }
+  });
+
+  BloomFilter &filter = searchKeyFilters[movieType];
+  filter.reset(keys.size() * 2);
+  for (const std::string &key : keys) {
+    filter.insert(key);
+  }
+}
+
+int Store::loadMovies(const std::string &filename) {
+  TRACE_SCOPE("loadMovies");
+  ALLOC_SCOPE(LOAD_MOVIES);
   std::ifstream file(filename);
   if (!file.is_open()) {
-    std::cerr << "Error: Could not open customer file " << filename
-              << std::endl;
+    *errorOutput << "Error: Could not open movie file " << filename
+                 << std::endl;
     return 0;
   }
 
@@ -203,7 +1121,7 @@ int Store::loadCustomers(const std::string &filename) {
       continue;
     }
 
-    if (processCustomerLine(line)) {
+    if (processMovieLine(line)) {
       count++;
     }
   }
@@ -212,6 +1130,222 @@ int Store::loadCustomers(const std::string &filename) {
   return count;
 }
 
+int Store::loadCustomers(const std::string &filename) {
+  int count = 0;
+  loadCustomers(filename, true, count);
+  return count;
+}
+
+bool Store::loadCustomers(const std::string &filename, bool quoteBadLines,
+                          int &count) {
+  TRACE_SCOPE("loadCustomers");
+  ALLOC_SCOPE(LOAD_CUSTOMERS);
+  count = 0;
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    *errorOutput << "Error: Could not open customer file " << filename
+                 << std::endl;
+    return false;
+  }
+
+  // Blank lines are kept, so a line's index gives its number
+  std::vector<std::string> lines;
+  {
+    TRACE_SCOPE("read customer file");
+    std::string line;
+    while (std::getline(file, line)) {
+      lines.push_back(std::move(line));
+    }
+  }
+  file.close();
+
+  // Parse (possibly in parallel), then add in file order so errors and
+  // duplicates are reported as they appear
+  std::vector<std::unique_ptr<Customer>> parsed = parseCustomerLines(lines);
+  TRACE_SCOPE("add customers");
+  customers.reserve(customers.size() + parsed.size());
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    if (lines[i].empty()) {
+      continue;
+    }
+    if (!parsed[i]) {
+      if (quoteBadLines) {
+        *errorOutput << "Failed to parse customer data: " << lines[i]
+                     << std::endl;
+      } else {
+        *errorOutput << "Invalid customer row at " << filename << ":"
+                     << i + 1 << ", skipping it" << std::endl;
+      }
+      continue;
+    }
+
+    if (addCustomer(std::move(parsed[i]))) {
+      count++;
+    }
+  }
+  return true;
+}
+
+std::vector<std::unique_ptr<Customer>>
+Store::parseCustomerLines(const std::vector<std::string> &lines) const {
+  TRACE_SCOPE("parseCustomerLines");
+  std::vector<std::unique_ptr<Customer>> parsed(lines.size());
+  auto parseRange = [&](size_t begin, size_t end) {
+    TRACE_SCOPE("parse customer slice");
+    ALLOC_SCOPE(LOAD_CUSTOMERS);
+    for (size_t i = begin; i < end; i++) {
+      if (!lines[i].empty()) {
+        std::istringstream iss(lines[i]);
+        parsed[i] = Customer::parseFromStream(iss, wideCustomerIDs);
+      }
+    }
+  };
+
+  size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+  if (lines.size() < PARALLEL_PARSE_MIN_LINES || numThreads == 1) {
+    parseRange(0, lines.size());
+    return parsed;
+  }
+
+  // Each thread fills its own contiguous slice of parsed
+  std::vector<std::thread> threads;
+  size_t sliceSize = (lines.size() + numThreads - 1) / numThreads;
+  for (size_t begin = 0; begin < lines.size(); begin += sliceSize) {
+    threads.emplace_back(parseRange, begin,
+                         std::min(begin + sliceSize, lines.size()));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  return parsed;
+}
+
+void Store::useFlatStorage(bool enabled) {
+  flatStorage = enabled;
+  if (!enabled) {
+    return;
+  }
+
+  // Registered genres supply their own contiguous storage
+  for (const auto &entry : genreTrees) {
+    auto store = MovieFactory::getInstance().createGenreStore(entry.first,
+                                                              movieTypeMask);
+    if (store) {
+      flatStores[entry.first] = std::move(store);
+    }
+  }
+}
+
+void Store::forEachMovie(char movieType,
+                         const std::function<void(Movie *)> &visit) const {
+  if (flatStorage) {
+    const GenreStore *flat = getFlatStore(movieType);
+    if (flat != nullptr) {
+      flat->forEach(visit);
+    }
+    return;
+  }
+
+  const BSTree<Movie *> *tree = getGenreTree(movieType);
+  if (tree != nullptr) {
+    tree->inOrderTraversal([&visit](Movie *const &movie) { visit(movie); });
+  }
+}
+
+void Store::forEachMovieSorted(
+    char movieType, const std::function<void(const Movie *)> &visit) const {
+  if (flatStorage) {
+    const GenreStore *flat = getFlatStore(movieType);
+    if (flat != nullptr) {
+      flat->forEachSorted(visit);
+    }
+    return;
+  }
+
+  const BSTree<Movie *> *tree = getGenreTree(movieType);
+  if (tree != nullptr) {
+    tree->inOrderTraversal([&visit](Movie *const &movie) { visit(movie); });
+  }
+}
+
+GenreStore *Store::getFlatStore(char movieType) const {
+  auto it = flatStores.find(movieType);
+  return (it != flatStores.end()) ? it->second.get() : nullptr;
+}
+
+void Store::useParallelRendering(size_t threads) {
+  renderPool.reset();
+  if (threads > 0) {
+    renderPool = std::make_unique<WorkStealingPool>(threads);
+  }
+}
+
+void Store::useWideCustomerIDs(bool enabled) { wideCustomerIDs = enabled; }
+
+void Store::setConsolidateRecords(bool enabled) {
+  consolidateRecords = enabled;
+}
+
+void Store::indexNamesAndKeys(Movie *target, const Movie &source) {
+  char movieType = target->getMovieType();
+
+  for (const std::string &actor : source.getMajorActors()) {
+    addToIndex(*actorIndex, StringPool::getInstance().intern(actor), target);
+    nameTrie->insert(actor, target);
+  }
+
+  // Keep the search key filter complete, growing it when full
+  BloomFilter &filter = searchKeyFilters[movieType];
+  GenreStore *flat = flatStorage ? getFlatStore(movieType) : nullptr;
+  for (const std::string &key : source.getSearchKeys()) {
+    searchKeyTries[movieType]->insert(key, target);
+    if (flat != nullptr) {
+      flat->addSearchKey(key, target);
+    }
+    if (filter.size() >= filter.capacity()) {
+      rebuildSearchKeyFilter(movieType);
+    } else {
+      filter.insert(key);
+    }
+  }
+}
+
+void Store::addToIndex(HashTable<InternedString, std::vector<Movie *>> &index,
+                       const InternedString &key, Movie *movie) {
+  std::vector<Movie *> *movies = index.find(key);
+  if (movies == nullptr) {
+    index.insert(key, {movie});
+  } else {
+    movies->push_back(movie);
+  }
+}
+
+void Store::removeFromIndex(
+    HashTable<InternedString, std::vector<Movie *>> &index,
+    const InternedString &key, Movie *movie) {
+  std::vector<Movie *> *movies = index.find(key);
+  if (movies == nullptr) {
+    return;
+  }
+
+  movies->erase(std::remove(movies->begin(), movies->end(), movie),
+                movies->end());
+  if (movies->empty()) {
+    index.erase(key);
+  }
+}
+
+const std::vector<Movie *> *Store::findInIndex(
+    const HashTable<InternedString, std::vector<Movie *>> &index,
+    const std::string &name) {
+  InternedString key;
+  if (!StringPool::getInstance().lookup(name, key)) {
+    return nullptr;
+  }
+  return index.find(key);
+}
+
 BSTree<Movie *> *Store::getGenreTree(char movieType) {
   auto it = genreTrees.find(movieType);
   if (it != genreTrees.end()) {
@@ -229,12 +1363,28 @@ const BSTree<Movie *> *Store::getGenreTree(char movieType) const {
 }
 
 bool Store::processMovieLine(const std::string &line) {
+  std::unique_ptr<Movie> movie;
+  {
+    TRACE_SCOPE("parseMovieLine");
+    movie = parseMovieLine(line);
+  }
+  if (!movie) {
+    return false;
+  }
+
+  // Add to inventory
+  TRACE_SCOPE("addMovie");
+  return addMovie(std::move(movie));
+}
+
+std::unique_ptr<Movie> Store::parseMovieLine(const std::string &line,
+                                             bool reportErrors) {
   std::istringstream iss(line);
   char movieType;
 
   // Read movie type
   if (!(iss >> movieType)) {
-    return false;
+    return nullptr;
   }
 
   // Skip comma after movie type
@@ -242,58 +1392,110 @@ bool Store::processMovieLine(const std::string &line) {
   iss >> comma;
 
   // Create movie using factory
-  auto movie = MovieFactory::getInstance().createMovie(movieType);
+  auto movie = MovieFactory::getInstance().createMovie(movieType,
+                                                     movieTypeMask);
   if (!movie) {
-    std::cerr << "Unknown movie type: " << movieType
-              << ", discarding line: " << line.substr(2) << std::endl;
-    return false;
+    if (reportErrors) {
+      *errorOutput << "Unknown movie type: " << movieType
+                   << ", discarding line: " << line.substr(2) << std::endl;
+    }
+    return nullptr;
   }
 
   // Parse movie data
   if (!movie->parseData(iss)) {
-    std::cerr << "Failed to parse movie data: " << line << std::endl;
-    return false;
+    if (reportErrors) {
+      *errorOutput << "Failed to parse movie data: " << line << std::endl;
+    }
+    return nullptr;
   }
 
-  // Add to inventory
-  return addMovie(std::move(movie));
+  return movie;
 }
 
-bool Store::processCustomerLine(const std::string &line) {
+bool Store::processCommandLine(const std::string &line) {
+  ALLOC_SCOPE(PARSE_COMMAND);
+  CommandStats::Clock::time_point start = CommandStats::Clock::now();
   std::istringstream iss(line);
-  auto customer = Customer::parseFromStream(iss);
+  char commandType;
 
-  if (!customer) {
-    std::cerr << "Failed to parse customer data: " << line << std::endl;
+  TRACE_SCOPE("processCommandLine");
+
+  // Read command type
+  if (!(iss >> commandType)) {
+    stats.count(CommandStats::PARSE_FAILURE);
     return false;
   }
-
-  return addCustomer(std::move(customer));
+  ALLOC_SCOPE_SET_COMMAND(commandType);
+  return processCommand(commandType, iss, start);
 }
 
-bool Store::processCommandLine(const std::string &line) {
+std::unique_ptr<SlicedReport>
+Store::startCommandLine(const std::string &line, bool &succeeded) {
+  CommandStats::Clock::time_point start = CommandStats::Clock::now();
   std::istringstream iss(line);
   char commandType;
+  succeeded = false;
 
-  // Read command type
+  TRACE_SCOPE("startCommandLine");
   if (!(iss >> commandType)) {
+    stats.count(CommandStats::PARSE_FAILURE);
+    return nullptr;
+  }
+  std::unique_ptr<Command> command = parseCommand(commandType, iss, start);
+  if (!command) {
+    return nullptr;
+  }
+
+  CommandStats::Clock::time_point parsed = CommandStats::Clock::now();
+  std::unique_ptr<SlicedReport> report = command->start(*this, succeeded);
+  if (!report) {
+    stats.recordExecute(commandType, CommandStats::Clock::now() - parsed,
+                        succeeded);
+  }
+  return report;
+}
+
+bool Store::processCommand(char commandType, std::istream &arguments,
+                           CommandStats::Clock::time_point start) {
+  std::unique_ptr<Command> command =
+      parseCommand(commandType, arguments, start);
+  if (!command) {
     return false;
   }
+  CommandStats::Clock::time_point parsed = CommandStats::Clock::now();
+
+  // Execute command
+  bool succeeded = false;
+  {
+    TRACE_SCOPE_TYPE("execute", commandType);
+    ALLOC_SCOPE_COMMAND(EXECUTE_COMMAND, commandType);
+    succeeded = command->execute(*this);
+  }
+  stats.recordExecute(commandType, CommandStats::Clock::now() - parsed,
+                      succeeded);
+  return succeeded;
+}
 
+std::unique_ptr<Command>
+Store::parseCommand(char commandType, std::istream &arguments,
+                    CommandStats::Clock::time_point start) {
   // Create command using factory
-  auto command = CommandFactory::getInstance().createCommand(commandType);
+  std::unique_ptr<Command> command =
+      CommandFactory::getInstance().createCommand(commandType, commandMask);
   if (!command) {
-    std::cerr << "Unknown command type: " << commandType
-              << ", discarding line: " << std::endl;
-    return false;
+    stats.count(CommandStats::UNKNOWN_COMMAND);
+    *errorOutput << "Unknown command type: " << commandType
+                 << ", discarding line: " << std::endl;
+    return nullptr;
   }
 
   // Set command parameters
-  if (!command->setParameters(iss)) {
+  if (!command->setParameters(arguments, *this)) {
     // Error already reported by setParameters
-    return false;
+    stats.count(CommandStats::PARSE_FAILURE);
+    return nullptr;
   }
-
-  // Execute command
-  return command->execute(*this);
+  stats.recordParse(CommandStats::Clock::now() - start);
+  return command;
 }
\ No newline at end of file
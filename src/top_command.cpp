@@ -0,0 +1,85 @@
+/**
+ * @location src/top_command.cpp
+ */
+
+#include "commands.h"
+#include "factory.h"
+#include "store.h"
+#include <iostream>
+
+// Self-registration with factory
+namespace {
+class TopRegistrar {
+public:
+  TopRegistrar() {
+    CommandFactory::getInstance().registerCommandType(
+        'T', []() { return std::make_unique<TopCommand>(); });
+  }
+};
+TopRegistrar topRegistrar;
+
+constexpr int DEFAULT_TOP_COUNT = 10;
+} // namespace
+
+TopCommand::TopCommand() : movieType('\0'), count(DEFAULT_TOP_COUNT) {}
+
+bool TopCommand::execute(Store &store) {
+  std::ostream &out = store.getMessageOutput();
+
+  out << "Debug: Top " << count << " for " << movieType << "\n";
+  out << "==========================\n";
+
+  auto entries = store.getTopBorrowed(movieType, count);
+  if (entries.empty()) {
+    out << "No borrows for " << movieType << "\n";
+    return true;
+  }
+
+  for (const auto &entry : entries) {
+    entry.movie->display(out);
+    out << ": " << entry.count << " borrows\n";
+  }
+
+  return true;
+}
+
+char TopCommand::getCommandType() const { return 'T'; }
+
+Command *TopCommand::clone() const { return new TopCommand(*this); }
+
+// Command format: T genre [count]
+bool TopCommand::setParameters(std::istream &input, const Store &store) {
+  if (!(input >> movieType)) {
+    return false;
+  }
+
+  if (!MovieFactory::getInstance().isValidMovieType(
+          movieType, store.getMovieTypeMask())) {
+    store.getErrorOutput() << "Invalid movie type " << movieType
+                           << ", discarding line: " << std::endl;
+    return false;
+  }
+
+  // Count is optional
+  if (!(input >> count)) {
+    count = DEFAULT_TOP_COUNT;
+  }
+
+  std::string remainder;
+  std::getline(input, remainder);
+
+  // Only the top entries are tracked, so more cannot be listed
+  size_t capacity = store.getTopBorrowedCapacity(movieType);
+  if (count > 0 && static_cast<size_t>(count) > capacity) {
+    store.getErrorOutput() << "Top count " << count << " is above the "
+                           << capacity << " titles tracked, discarding line: "
+                           << std::endl;
+    return false;
+  }
+
+  return count > 0;
+}
+
+std::string TopCommand::getDescription() const {
+  return std::string("Top ") + movieType;
+}
@@ -0,0 +1,102 @@
+/**
+ * @location src/workpool.cpp
+ */
+
+#include "workpool.h"
+
+WorkStealingPool::WorkStealingPool(size_t threadCount)
+    : stopping(false), unclaimed(0), remaining(0) {
+  for (size_t i = 0; i <= threadCount; i++) {
+    deques.push_back(std::make_unique<TaskDeque>());
+  }
+  for (size_t i = 0; i < threadCount; i++) {
+    threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::runAll(std::vector<Task> &tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> batch(batchMutex);
+  {
+    // Counted before any can be taken, so the counts never go negative
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    remaining = tasks.size();
+    unclaimed = tasks.size();
+  }
+
+  // Deal the tasks out in turn, so each deque starts with a share
+  for (size_t i = 0; i < tasks.size(); i++) {
+    TaskDeque &deque = *deques[i % deques.size()];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    deque.tasks.push_back(&tasks[i]);
+  }
+  wake.notify_all();
+
+  // The caller works too, from the last deque
+  while (runOne(deques.size() - 1)) {
+  }
+
+  std::unique_lock<std::mutex> lock(sleepMutex);
+  finished.wait(lock, [this]() { return remaining == 0; });
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+  for (;;) {
+    if (runOne(index)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wake.wait(lock, [this]() { return stopping || unclaimed > 0; });
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::runOne(size_t index) {
+  Task *task = nullptr;
+
+  // Newest of our own first, while its data is likely still in cache
+  {
+    TaskDeque &own = *deques[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = own.tasks.back();
+      own.tasks.pop_back();
+    }
+  }
+
+  // Then the oldest of another, starting from our neighbour
+  for (size_t i = 1; task == nullptr && i < deques.size(); i++) {
+    TaskDeque &victim = *deques[(index + i) % deques.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+    }
+  }
+
+  if (task == nullptr) {
+    return false;
+  }
+  unclaimed--;
+  (*task)();
+  if (--remaining == 0) {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    finished.notify_all();
+  }
+  return true;
+}
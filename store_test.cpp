@@ -5,11 +5,38 @@
  * @date 19 Jan 2019
  */
 
+#include "bstree.h"
+#include "catalogcolumns.h"
+#include "commandlog.h"
+#include "commandstats.h"
+#include "corental.h"
+#include "customer.h"
+#include "customerindex.h"
+#include "factory.h"
+#include "leaderboard.h"
+#include "scheduler.h"
+#include "server.h"
+#include "store.h"
+#include "transactionlog.h"
+#include "trie.h"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <sstream>
+#include <vector>
+
+#ifdef STORE_SERVER
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -38,6 +65,1049 @@ void testStore2() {
   cout << "End testStore2" << endl;
 }
 
+void testCountMinSketch() {
+  cout << "Start testCountMinSketch" << endl;
+  CountMinSketch sketch(64, 4);
+  int keys[100];
+  for (int i = 0; i < 100; i++) {
+    for (int j = 0; j <= i % 5; j++) {
+      sketch.increment(&keys[i]);
+    }
+  }
+  // Estimates never undercount
+  for (int i = 0; i < 100; i++) {
+    assert(sketch.estimate(&keys[i]) >= static_cast<uint32_t>(i % 5 + 1));
+  }
+  cout << "End testCountMinSketch" << endl;
+}
+
+void testLeaderboard() {
+  cout << "Start testLeaderboard" << endl;
+  vector<unique_ptr<Movie>> movies;
+  for (int i = 0; i < 4; i++) {
+    movies.push_back(MovieFactory::getInstance().createMovie('F'));
+  }
+  const Movie *a = movies[0].get();
+  const Movie *b = movies[1].get();
+  const Movie *c = movies[2].get();
+  const Movie *d = movies[3].get();
+
+  // Ties keep the title that reached the count first ahead
+  Leaderboard board(2);
+  board.recordBorrow(a);
+  board.recordBorrow(b);
+  vector<Leaderboard::Entry> top = board.top(5);
+  assert(top.size() == 2 && top[0].movie == a && top[1].movie == b);
+
+  // Tying the last entry does not evict it; passing it does
+  board.recordBorrow(c);
+  top = board.top(5);
+  assert(top.size() == 2 && top[1].movie == b);
+  assert(board.recordBorrow(c) == 2);
+  top = board.top(5);
+  assert(top[0].movie == c && top[0].count == 2 && top[1].movie == a);
+  assert(board.getCount(b) == 1);
+
+  // A removed title's slot goes to the highest count left out, here b
+  // with 2 rather than a with 1
+  board.recordBorrow(d);
+  board.recordBorrow(d);
+  board.recordBorrow(b);
+  top = board.top(5);
+  assert(top.size() == 2 && top[0].movie == c && top[1].movie == d);
+  board.remove(c);
+  assert(board.getCount(c) == 0);
+  top = board.top(5);
+  assert(top.size() == 2 && top[0].movie == d && top[1].movie == b);
+  assert(top[1].count == 2);
+
+  // Sketch counts are never below the true count
+  Leaderboard approximate(2);
+  approximate.useSketch(64, 4);
+  for (int i = 0; i < 3; i++) {
+    approximate.recordBorrow(a);
+  }
+  approximate.recordBorrow(b);
+  assert(approximate.top(1).front().movie == a);
+  assert(approximate.getCount(a) >= 3 && approximate.getCount(b) >= 1);
+
+  // A sketch cannot list its titles, so a freed slot waits for a borrow
+  approximate.recordBorrow(c);
+  approximate.remove(a);
+  assert(approximate.top(5).size() == 1);
+
+  // T cannot list more titles than a genre's leaderboard tracks
+  stringstream sink;
+  Store store;
+  store.setOutput(sink, sink);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+  size_t capacity = store.getTopBorrowedCapacity('F');
+  assert(capacity > 0);
+  assert(store.processCommandLine("T F " + to_string(capacity)));
+  assert(!store.processCommandLine("T F " + to_string(capacity + 1)));
+  cout << "End testLeaderboard" << endl;
+}
+
+void testTrie() {
+  cout << "Start testTrie" << endl;
+  Trie<int> trie;
+  trie.insert("Holiday", 1);
+  trie.insert("Hollywood", 2);
+  trie.insert("Harold and Maude", 3);
+  assert(trie.size() == 3);
+  assert(trie.findPrefix("Hol", 10).size() == 2);
+  assert(trie.findPrefix("Ha", 10).front() == 3);
+  assert(trie.findPrefix("X", 10).empty());
+  const int *nearest = trie.findNearest("Holliday", 2);
+  assert(nearest != nullptr && *nearest == 1);
+  assert(trie.findNearest("Casablanca", 2) == nullptr);
+  cout << "End testTrie" << endl;
+}
+
+void testNameIndexes() {
+  cout << "Start testNameIndexes" << endl;
+  stringstream out;
+  Store store;
+  store.setOutput(out, out);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+
+  // Sorted titles the index holds for a name, empty if none
+  auto titles = [](const vector<Movie *> *movies) {
+    vector<string> result;
+    if (movies != nullptr) {
+      for (const Movie *movie : *movies) {
+        result.push_back(movie->getTitle());
+      }
+    }
+    sort(result.begin(), result.end());
+    return result;
+  };
+
+  // A director's titles come from every genre
+  unique_ptr<Movie> drama = MovieFactory::getInstance().createMovie('D');
+  stringstream data(" 4, Hal Ashby, Coming Home, 1978");
+  assert(drama->parseData(data));
+  assert(store.addMovie(move(drama)));
+  assert((titles(store.findByDirector("Hal Ashby")) ==
+          vector<string>{"Coming Home", "Harold and Maude"}));
+  // Unconsolidated, each Classic row is its own record
+  assert((titles(store.findByDirector("Victor Fleming")) ==
+          vector<string>{"Gone With the Wind", "Gone With the Wind",
+                         "The Wizard of Oz"}));
+  assert(titles(store.findByDirector("Nobody Here")).empty());
+
+  // An actor's titles include every Classic row they are listed on
+  assert((titles(store.findByActor("Humphrey Bogart")) ==
+          vector<string>{"Casablanca", "The Maltese Falcon"}));
+  assert((titles(store.findByActor("Katherine Hepburn")) ==
+          vector<string>{"Holiday", "The Philadelphia Story"}));
+
+  // W and A print from the same indexes
+  out.str("");
+  assert(store.processCommandLine("W Hal Ashby"));
+  assert(out.str().find("Coming Home") != string::npos);
+  assert(out.str().find("Harold and Maude") != string::npos);
+  out.str("");
+  assert(store.processCommandLine("A Humphrey Bogart"));
+  assert(out.str().find("Casablanca") != string::npos);
+  assert(out.str().find("The Maltese Falcon") != string::npos);
+
+  // Retired titles leave both indexes; a name left with none has none
+  assert(store.retireMovie('C', "3 1971 Ruth Gordon"));
+  assert(store.retireMovie('C', "10 1941 Humphrey Bogart"));
+  assert(store.retireMovie('C', "2 1971 Malcolm McDowell"));
+  assert((titles(store.findByDirector("Hal Ashby")) ==
+          vector<string>{"Coming Home"}));
+  assert((titles(store.findByActor("Humphrey Bogart")) ==
+          vector<string>{"Casablanca"}));
+  assert(store.findByDirector("Stanley Kubrick") == nullptr);
+  assert(store.findByActor("Malcolm McDowell") == nullptr);
+  out.str("");
+  assert(store.processCommandLine("A Malcolm McDowell"));
+  assert(out.str().find("No titles with Malcolm McDowell") != string::npos);
+  out.str("");
+  assert(store.processCommandLine("W Hal Ashby"));
+  assert(out.str().find("Harold and Maude") == string::npos);
+  cout << "End testNameIndexes" << endl;
+}
+
+void testConsolidatedRecords() {
+  cout << "Start testConsolidatedRecords" << endl;
+  stringstream sink;
+  Store separate;
+  Store merged;
+  separate.setOutput(sink, sink);
+  merged.setOutput(sink, sink);
+  merged.setConsolidateRecords(true);
+  assert(separate.initialize("data4movies.txt", "data4customers.txt"));
+  assert(merged.initialize("data4movies.txt", "data4customers.txt"));
+
+  // Other genres list the same; Classic rows fold into one per film
+  // with their stock pooled
+  auto summarize = [](Store &store, vector<string> &others, int &classics,
+                      int &classicStock) {
+    stringstream inventory;
+    store.displayInventory(inventory);
+    string line;
+    while (getline(inventory, line)) {
+      if (line.find(" - Classics") == string::npos) {
+        others.push_back(line);
+        continue;
+      }
+      size_t open = line.rfind('(');
+      classics++;
+      classicStock += stoi(line.substr(open + 1));
+    }
+  };
+  vector<string> separateOthers;
+  vector<string> mergedOthers;
+  int separateClassics = 0;
+  int mergedClassics = 0;
+  int separateStock = 0;
+  int mergedStock = 0;
+  summarize(separate, separateOthers, separateClassics, separateStock);
+  summarize(merged, mergedOthers, mergedClassics, mergedStock);
+  assert(mergedOthers == separateOthers);
+  assert(separateClassics == 14 && mergedClassics == 9);
+  assert(mergedStock == separateStock);
+
+  // Either actor's key reaches the same copies
+  assert(merged.processCommandLine("B 1000 D C 8 1942 Humphrey Bogart"));
+  stringstream inventory;
+  merged.displayInventory(inventory);
+  assert(inventory.str().find("1942 8, Ingrid Bergman & Humphrey Bogart, "
+                              "Michael Curtiz, Casablanca (19)") !=
+         string::npos);
+  assert(merged.processCommandLine("R 1000 D C 8 1942 Ingrid Bergman"));
+  inventory.str("");
+  merged.displayInventory(inventory);
+  assert(inventory.str().find("Casablanca (20)") != string::npos);
+  cout << "End testConsolidatedRecords" << endl;
+}
+
+void testFlatStorage() {
+  cout << "Start testFlatStorage" << endl;
+  stringstream treeOut;
+  stringstream treeErr;
+  stringstream flatOut;
+  stringstream flatErr;
+  Store tree;
+  Store flat;
+  tree.setOutput(treeOut, treeErr);
+  flat.setOutput(flatOut, flatErr);
+  flat.useFlatStorage(true);
+  assert(tree.initialize("data4movies.txt", "data4customers.txt"));
+  assert(flat.initialize("data4movies.txt", "data4customers.txt"));
+
+  // The sample commands, retiring a title part way, print the same
+  assert(tree.processCommands("data4commands.txt"));
+  assert(flat.processCommands("data4commands.txt"));
+  for (Store *store : {&tree, &flat}) {
+    assert(store->processCommandLine("E F You've Got Mail, 1998"));
+    assert(store->processCommandLine("I"));
+  }
+  assert(!treeOut.str().empty());
+  assert(flatOut.str() == treeOut.str());
+  assert(flatErr.str() == treeErr.str());
+  cout << "End testFlatStorage" << endl;
+}
+
+void testFilterStats() {
+  cout << "Start testFilterStats" << endl;
+  stringstream sink;
+  Store store;
+  store.setOutput(sink, sink);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+  BloomFilter::Stats customersBefore = store.getCustomerFilterStats();
+  BloomFilter::Stats moviesBefore = store.getMovieFilterStats();
+
+  // A closed customer or retired title stays in its filter, so looking
+  // it up again is a false positive
+  assert(store.findCustomer("1000") != nullptr);
+  assert(store.findCustomer("1234") == nullptr);
+  assert(store.closeCustomer("2000"));
+  assert(store.findCustomer("2000") == nullptr);
+  assert(store.retireMovie('F', "Fargo,1996"));
+  assert(store.findMovie('F', "Fargo,1996") == nullptr);
+  assert(store.findMovie('F', "No Such Title,1900") == nullptr);
+
+  const BloomFilter::Stats &customers = store.getCustomerFilterStats();
+  BloomFilter::Stats movies = store.getMovieFilterStats();
+  assert(customers.lookups >= customersBefore.lookups + 3);
+  assert(customers.falsePositives > customersBefore.falsePositives);
+  assert(movies.lookups >= moviesBefore.lookups + 2);
+  assert(movies.falsePositives > moviesBefore.falsePositives);
+
+  // Growing the filter drops closed customers, so 2000 is then rejected
+  // outright rather than passed as a false positive
+  for (uint64_t id = 3000; id < 3200; id++) {
+    assert(store.addCustomer(
+        make_unique<Customer>(id, Customer::ID_DIGITS, "Last", "First")));
+  }
+  BloomFilter::Stats grown = store.getCustomerFilterStats();
+  assert(store.findCustomer("2000") == nullptr);
+  assert(store.getCustomerFilterStats().rejected == grown.rejected + 1);
+  assert(store.getCustomerFilterStats().falsePositives ==
+         grown.falsePositives);
+
+  stringstream report;
+  store.reportStats(report);
+  assert(report.str().find("Customer filter: " +
+                           to_string(customers.lookups) + " lookups") !=
+         string::npos);
+  assert(report.str().find("Movie filter: " + to_string(movies.lookups) +
+                           " lookups") != string::npos);
+
+  // Directors and actors repeat across the movie file, so interning saves
+  size_t saved = StringPool::getInstance().bytesSaved();
+  assert(saved > 0);
+  assert(report.str().find(" strings, " + to_string(saved) +
+                           " duplicate bytes saved\n") != string::npos);
+  cout << "End testFilterStats" << endl;
+}
+
+void testCatalogColumns() {
+  cout << "Start testCatalogColumns" << endl;
+  // Per-genre totals and the low-stock list skip retired rows
+  vector<unique_ptr<Movie>> movies;
+  CatalogColumns columns;
+  for (string row : {"F, 3, A B, One, 2001", "F, 0, A B, Two, 2002",
+                     "D, 5, C D, Three, 2003"}) {
+    movies.push_back(MovieFactory::getInstance().createMovie(row[0]));
+    stringstream data(row.substr(2));
+    assert(movies.back()->parseData(data));
+    assert(columns.add(movies.back().get()) == movies.size() - 1);
+  }
+  assert(columns.totalStock('F') == 3 && columns.totalStock('D') == 5);
+  assert(columns.totalStock('C') == 0);
+  assert((columns.stockBelow(1) == vector<Movie *>{movies[1].get()}));
+  assert(columns.countStockBelow(4) == 2);
+  columns.updateStock(0, 7);
+  columns.retire(1);
+  assert(columns.totalStock('F') == 7 && columns.stockBelow(1).empty());
+  assert(!columns.isActive(1) && columns.movieAt(2) == movies[2].get());
+
+  // The store's shelf counts match the movie file, where every valid row
+  // is a title of its own
+  stringstream out;
+  Store store;
+  store.setOutput(out, out);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+  map<char, int64_t> expected;
+  ifstream file("data4movies.txt");
+  string line;
+  while (getline(file, line)) {
+    if (!line.empty() && string("FDC").find(line[0]) != string::npos) {
+      expected[line[0]] += stoi(line.substr(2));
+    }
+  }
+  for (char genre : {'F', 'D', 'C'}) {
+    assert(expected[genre] > 0);
+    assert(store.getShelfCopies(genre) == expected[genre]);
+  }
+  assert(store.findStockBelow(2).empty());
+  for (const char *command : {"L", "O"}) {
+    out.str("");
+    assert(store.processCommandLine(command));
+    assert(out.str().find("No titles found") != string::npos);
+  }
+
+  // Borrowing every copy puts a title on both lists
+  const string mail = "F You've Got Mail, 1998";
+  for (int copy = 0; copy < 10; copy++) {
+    assert(store.processCommandLine("B 1000 D " + mail));
+  }
+  assert(store.getShelfCopies('F') == expected['F'] - 10);
+  vector<Movie *> empty = store.findStockBelow(1);
+  assert(empty.size() == 1 && empty[0]->getTitle() == "You've Got Mail");
+  assert(store.findStockBelow(2) == empty);
+  for (const char *command : {"L", "O"}) {
+    out.str("");
+    assert(store.processCommandLine(command));
+    assert(out.str().find("You've Got Mail") != string::npos);
+  }
+
+  // Retired titles leave the totals and the lists
+  assert(store.retireMovie('F', "You've Got Mail,1998"));
+  assert(store.retireMovie('F', "Fargo,1996"));
+  assert(store.getShelfCopies('F') == expected['F'] - 20);
+  assert(store.findStockBelow(1).empty());
+  out.str("");
+  assert(store.processCommandLine("O"));
+  assert(out.str().find("No titles found") != string::npos);
+  cout << "End testCatalogColumns" << endl;
+}
+
+void testCompactTransaction() {
+  cout << "Start testCompactTransaction" << endl;
+  CompactTransaction record(Transaction::RETURN, 123456, 0x7FFFFFFE);
+  assert(record.getType() == Transaction::RETURN);
+  assert(record.getMovieIndex() == 123456);
+  assert(record.getSequence() == 0x7FFFFFFE);
+  CompactTransaction copy = CompactTransaction::fromBits(record.getBits());
+  assert(copy.getBits() == record.getBits());
+  assert(CompactTransaction(Transaction::BORROW, 7, 1).getType() ==
+         Transaction::BORROW);
+  cout << "End testCompactTransaction" << endl;
+}
+
+void testBSTreeErase() {
+  cout << "Start testBSTreeErase" << endl;
+  // Items are (key, id); only keys are compared, so equal keys are
+  // duplicates that must keep insertion order
+  using Item = pair<int, int>;
+  auto byKey = [](const Item &a, const Item &b) { return a.first < b.first; };
+  BSTree<Item> tree;
+  vector<Item> expected;
+  unsigned seed = 12345;
+  auto next = [&seed]() {
+    seed = seed * 1103515245 + 12345;
+    return static_cast<int>((seed >> 16) % 50);
+  };
+  auto check = [&]() {
+    vector<Item> walked;
+    tree.inOrderTraversal([&](const Item &item) { walked.push_back(item); });
+    vector<Item> sorted = expected;
+    stable_sort(sorted.begin(), sorted.end(), byKey);
+    assert(walked == sorted);
+    assert(tree.size() == expected.size());
+
+    // AVL height is below 1.45 log2(n + 2)
+    assert(tree.getHeight() <= 1.45 * log2(expected.size() + 2));
+  };
+
+  for (int id = 0; id < 1000; id++) {
+    Item item(next(), id);
+    tree.insert(item, byKey);
+    expected.push_back(item);
+  }
+  check();
+
+  // Erase three in four, picking among equal keys, checking as it shrinks
+  for (int round = 0; round < 750; round++) {
+    size_t victim = (next() * 97 + round) % expected.size();
+    assert(tree.erase(expected[victim], byKey));
+    assert(!tree.erase(expected[victim], byKey));
+    expected.erase(expected.begin() + victim);
+    if (round % 50 == 0) {
+      check();
+    }
+  }
+  check();
+
+  // Inserts after erases still land after their equal keys
+  for (int id = 1000; id < 1200; id++) {
+    Item item(next(), id);
+    tree.insert(item, byKey);
+    expected.push_back(item);
+  }
+  check();
+  cout << "End testBSTreeErase" << endl;
+}
+
+void testRetireThenReturn() {
+  cout << "Start testRetireThenReturn" << endl;
+  for (bool flat : {false, true}) {
+    stringstream out;
+    stringstream err;
+    Store store;
+    store.setOutput(out, err);
+    store.useFlatStorage(flat);
+    assert(store.initialize("data4movies.txt", "data4customers.txt"));
+
+    // A copy out when its title retires can still come back, and history
+    // still names it; the title is no longer listed or lent
+    assert(store.processCommandLine("B 1000 D F You've Got Mail, 1998"));
+    assert(store.processCommandLine("E F You've Got Mail, 1998"));
+    assert(store.processCommandLine("R 1000 D F You've Got Mail, 1998"));
+    assert(!store.processCommandLine("B 1000 D F You've Got Mail, 1998"));
+
+    stringstream history;
+    assert(store.displayCustomerHistory("1000", history, OutputFormat::CSV));
+    assert(history.str() == "customer,type,sequence,genre,title\n"
+                            "1000,borrow,0,F,You've Got Mail\n"
+                            "1000,return,1,F,You've Got Mail\n");
+    stringstream inventory;
+    store.displayInventory(inventory);
+    assert(!inventory.str().empty());
+    assert(inventory.str().find("You've Got Mail") == string::npos);
+  }
+  cout << "End testRetireThenReturn" << endl;
+}
+
+void testCustomerIndexErase() {
+  cout << "Start testCustomerIndexErase" << endl;
+  std::vector<Customer> people;
+  for (uint64_t id = 0; id < 200; id++) {
+    people.emplace_back(id, Customer::ID_DIGITS, "Last", "First");
+  }
+
+  CustomerIndex index;
+  for (Customer &person : people) {
+    assert(index.insert(person.getNumericID(), &person));
+  }
+
+  // Every other entry gone, the rest still reachable past the gaps
+  for (uint64_t id = 0; id < 200; id += 2) {
+    assert(index.erase(id));
+  }
+  assert(!index.erase(0));
+  assert(index.size() == 100);
+  for (uint64_t id = 0; id < 200; id++) {
+    assert((index.find(id) == nullptr) == (id % 2 == 0));
+  }
+  cout << "End testCustomerIndexErase" << endl;
+}
+
+void testWideCustomerIDs() {
+  cout << "Start testWideCustomerIDs" << endl;
+  uint64_t id = 0;
+  assert(Customer::parseID("0123", false, id) && id == 123);
+  assert(!Customer::parseID("123", false, id));
+  assert(Customer::parseID("1234567890123456789", true, id));
+  assert(id == 1234567890123456789ULL);
+  assert(Customer::parseID("0", true, id) && id == 0);
+  assert(!Customer::parseID("0123", true, id));
+  assert(!Customer::parseID("12345678901234567890", true, id));
+
+  // A leading zero is refused rather than taken for another customer
+  const string filename = "wide-test.customers";
+  {
+    ofstream customers(filename);
+    customers << "123 Short Sam\n";
+    customers << "0123 Padded Pat\n";
+    customers << "98765432101 Long Lee\n";
+  }
+  stringstream out;
+  stringstream err;
+  Store store;
+  store.setOutput(out, err);
+  store.useWideCustomerIDs(true);
+  assert(store.initialize("data4movies.txt", filename));
+  std::remove(filename.c_str());
+  assert(err.str().find("Failed to parse customer data: 0123") !=
+         string::npos);
+  assert(store.findCustomer("123") != nullptr);
+  assert(store.findCustomer("0123") == nullptr);
+  assert(store.findCustomer("98765432101") != nullptr);
+  assert(store.processCommandLine("B 98765432101 D F Fargo, 1996"));
+  assert(!store.processCommandLine("H 0123"));
+  cout << "End testWideCustomerIDs" << endl;
+}
+
+void testCoRentalIndex() {
+  cout << "Start testCoRentalIndex" << endl;
+  CoRentalIndex index(2);
+  // Customer 1 rents 0, 1, 2; customer 2 rents 0, 1
+  index.recordBorrow(1, 0);
+  index.recordBorrow(1, 1);
+  index.recordBorrow(1, 1); // Already in the window, not paired again
+  index.recordBorrow(1, 2);
+  index.recordBorrow(2, 0);
+  index.recordBorrow(2, 1);
+
+  auto top = index.neighbours(0, 2);
+  assert(top.size() == 2);
+  assert(top[0].movieIndex == 1 && top[0].count == 2);
+  assert(top[1].movieIndex == 2 && top[1].count == 1);
+
+  // A third neighbour evicts the smallest and inherits its count
+  index.recordBorrow(3, 0);
+  index.recordBorrow(3, 3);
+  top = index.neighbours(0, 2);
+  assert(top[0].movieIndex == 1 && top[0].count == 2);
+  assert(top[1].movieIndex == 3 && top[1].count == 2);
+  assert(index.neighbours(7, 2).empty());
+  cout << "End testCoRentalIndex" << endl;
+}
+
+void testLatencyHistogram() {
+  cout << "Start testLatencyHistogram" << endl;
+  LatencyHistogram histogram;
+  assert(histogram.percentile(0.5) == 0);
+  for (uint64_t value = 1; value <= 1000; value++) {
+    histogram.record(value * 1000);
+  }
+  assert(histogram.getCount() == 1000);
+  assert(histogram.getMax() == 1000000);
+
+  // Bucket edges are within about 3% above the exact percentile
+  uint64_t median = histogram.percentile(0.5);
+  assert(median >= 500000 && median <= 500000 * 103 / 100);
+  uint64_t p99 = histogram.percentile(0.99);
+  assert(p99 >= 990000 && p99 <= 1000000);
+  assert(histogram.percentile(1.0) == 1000000);
+  cout << "End testLatencyHistogram" << endl;
+}
+
+void testTypeMask() {
+  cout << "Start testTypeMask" << endl;
+  TypeMask mask;
+  assert(CommandFactory::getInstance().createCommand('I', mask) != nullptr);
+  assert(MovieFactory::getInstance().isValidMovieType('D', mask));
+
+  // Masked types look unregistered; other types are unaffected
+  mask.disable('I');
+  mask.disable('D');
+  assert(CommandFactory::getInstance().createCommand('I', mask) == nullptr);
+  assert(!CommandFactory::getInstance().isValidCommandType('I', mask));
+  assert(CommandFactory::getInstance().isValidCommandType('I'));
+  assert(MovieFactory::getInstance().createMovie('D', mask) == nullptr);
+  assert(MovieFactory::getInstance().createGenreStore('D', mask) == nullptr);
+  assert(MovieFactory::getInstance().isValidMovieType('D'));
+  assert(mask.allows('H'));
+  cout << "End testTypeMask" << endl;
+}
+
+void testCommandLog() {
+  cout << "Start testCommandLog" << endl;
+  const string filename = "commandlog-test.bin";
+  CommandLogWriter writer;
+  assert(writer.open(filename));
+  writer.writeCommand(1500, 'B', " 1000 D F You've Got Mail, 1998");
+  writer.writeCommand(0, '\0', "");
+  writer.writeCheckpoint({2, 0x0123456789abcdefULL, 42});
+  assert(writer.close());
+
+  CommandLogReader reader;
+  assert(reader.open(filename));
+  CommandLogReader::Record record;
+  assert(reader.next(record));
+  assert(record.kind == CommandLogReader::Record::COMMAND);
+  assert(record.gapMicros == 1500 && record.commandType == 'B');
+  assert(record.arguments == " 1000 D F You've Got Mail, 1998");
+  assert(reader.next(record) && record.commandType == '\0');
+  assert(record.arguments.empty());
+  assert(reader.next(record));
+  assert(record.kind == CommandLogReader::Record::CHECKPOINT);
+  assert(record.checkpoint.commands == 2);
+  assert(record.checkpoint.outputHash == 0x0123456789abcdefULL);
+  assert(record.checkpoint.stateHash == 42);
+  assert(!reader.next(record) && !reader.isDamaged());
+  std::remove(filename.c_str());
+
+  // Deltas picked up by a watch would not be in the log, so a capture
+  // refuses to start
+  stringstream sink;
+  Store store;
+  store.setOutput(sink, sink);
+  assert(store.watchDeltaDirectory("."));
+  assert(!store.captureCommands("data4commands.txt", filename, 0));
+
+  // Hashes depend on content and order, not on how writes are split
+  StreamHash whole;
+  StreamHash pieces;
+  HashingStreamBuffer buffer(nullptr, pieces);
+  ostream out(&buffer);
+  whole.update("abc", 3);
+  out << 'a' << "bc";
+  assert(whole.value() == pieces.value());
+  cout << "End testCommandLog" << endl;
+}
+
+void testDeltaCommand() {
+  cout << "Start testDeltaCommand" << endl;
+  const string filename = "delta-test.movies";
+  {
+    ofstream delta(filename);
+    delta << "root:x:0:0:root:/root:/bin/bash\n";
+    delta << "F, 5, Nora Ephron, You've Got Mail, 1998\n";
+  }
+  stringstream out;
+  stringstream err;
+  Store store;
+  store.setOutput(out, err);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+
+  // Files come only from the watched directory, named without a path
+  assert(!store.processCommandLine("U M " + filename));
+  assert(store.watchDeltaDirectory("."));
+  assert(!store.processCommandLine("U M /etc/passwd"));
+  assert(!store.processCommandLine("U M ../" + filename));
+  assert(!store.processCommandLine("U M .."));
+
+  // A file that cannot be opened fails, rather than ingesting 0 rows
+  assert(!store.processCommandLine("U C no-such-delta.customers"));
+  assert(err.str().find("Could not open customer file") != string::npos);
+  assert(out.str().find("Ingested") == string::npos);
+
+  // Rows that do not parse are reported by line number, not quoted
+  err.str("");
+  assert(store.processCommandLine("U M " + filename));
+  std::remove(filename.c_str());
+  assert(err.str().find(filename + ":1") != string::npos);
+  assert(err.str().find("root:x") == string::npos);
+  assert(out.str().find("Ingested 1 movies") != string::npos);
+  stringstream inventory;
+  store.displayInventory(inventory);
+  assert(inventory.str().find("You've Got Mail, 1998, Nora Ephron (15)") !=
+         string::npos);
+
+  // A scheduler, as the server runs, ingests files dropped in meanwhile
+  const string dropped = "delta-test-dropped.movies";
+  {
+    ofstream delta(dropped);
+    delta << "F, 2, Jo Lee, Zzzz, 2001\n";
+  }
+  bool borrowed = false;
+  {
+    CommandScheduler scheduler(store);
+    scheduler.submit("B 1000 D F Zzzz, 2001",
+                     [&](const string &, bool succeeded) {
+                       borrowed = succeeded;
+                     });
+    while (scheduler.runStep()) {
+    }
+  }
+  std::remove(dropped.c_str());
+  assert(borrowed);
+  cout << "End testDeltaCommand" << endl;
+}
+
+void testEncodedOutput() {
+  cout << "Start testEncodedOutput" << endl;
+  // With JSON Lines as the store's format, the output holds only records
+  // and the Debug lines, banners and Done go to the error output
+  stringstream out;
+  stringstream err;
+  Store jsonStore;
+  jsonStore.setOutputFormat(OutputFormat::JSON_LINES);
+  jsonStore.setOutput(out, err);
+  assert(jsonStore.initialize("data4movies.txt", "data4customers.txt"));
+  assert(jsonStore.processCommands("data4commands.txt"));
+  string line;
+  size_t records = 0;
+  while (getline(out, line)) {
+    assert(!line.empty() && line.front() == '{' && line.back() == '}');
+    records++;
+  }
+  assert(records > 0);
+  assert(err.str().find("Debug: Borrow") != string::npos);
+
+  auto comedy = [](const string &fields) {
+    unique_ptr<Movie> movie = MovieFactory::getInstance().createMovie('F');
+    stringstream data(fields);
+    assert(movie->parseData(data));
+    return movie;
+  };
+  unique_ptr<Movie> quoted = comedy(" 3, Jo \"JJ\" Lee, Say \"Cheese\", 2001");
+
+  // Quotes are escaped the way each format escapes them
+  FormatBuffer json;
+  OutputEncoder::create(OutputFormat::JSON_LINES)->encodeMovie(*quoted, json);
+  assert(json.str() == "{\"genre\":\"F\",\"title\":\"Say \\\"Cheese\\\"\","
+                       "\"director\":\"Jo \\\"JJ\\\" Lee\",\"year\":2001,"
+                       "\"stock\":3}\n");
+  FormatBuffer csv;
+  OutputEncoder::create(OutputFormat::CSV)->encodeMovie(*quoted, csv);
+  assert(csv.str() ==
+         "F,\"Say \"\"Cheese\"\"\",\"Jo \"\"JJ\"\" Lee\",2001,,,3\n");
+
+  // Binary records decode back to the movie's fields
+  FormatBuffer binary;
+  OutputEncoder::create(OutputFormat::BINARY)->encodeMovie(*quoted, binary);
+  string bytes = binary.str();
+  size_t at = 0;
+  auto readInteger = [&](int width) {
+    uint32_t value = 0;
+    for (int i = 0; i < width; i++) {
+      value |= uint32_t{static_cast<unsigned char>(bytes[at++])} << (8 * i);
+    }
+    return value;
+  };
+  auto readString = [&]() {
+    size_t length = readInteger(2);
+    at += length;
+    return bytes.substr(at - length, length);
+  };
+  assert(readInteger(4) == bytes.size() - 4);
+  assert(bytes[at++] == 'M' && bytes[at++] == 'F');
+  assert(readInteger(4) == 3 && readInteger(4) == 2001 && readInteger(1) == 0);
+  assert(readString() == "Jo \"JJ\" Lee");
+  assert(readString() == "Say \"Cheese\"");
+  assert(readInteger(1) == 0 && at == bytes.size());
+
+  // A consolidated Classic lists each of its actors in every format
+  auto classic = [](const string &fields) {
+    unique_ptr<Movie> movie = MovieFactory::getInstance().createMovie('C');
+    stringstream data(fields);
+    assert(movie->parseData(data));
+    return movie;
+  };
+  unique_ptr<Movie> casablanca =
+      classic(" 10, Michael Curtiz, Casablanca, Ingrid Bergman 8 1942");
+  casablanca->mergeFrom(
+      *classic(" 10, Michael Curtiz, Casablanca, Humphrey Bogart 8 1942"));
+  json.clear();
+  OutputEncoder::create(OutputFormat::JSON_LINES)
+      ->encodeMovie(*casablanca, json);
+  assert(json.str() ==
+         "{\"genre\":\"C\",\"title\":\"Casablanca\",\"director\":"
+         "\"Michael Curtiz\",\"year\":1942,\"month\":8,\"actors\":"
+         "[\"Ingrid Bergman\",\"Humphrey Bogart\"],\"stock\":20}\n");
+  csv.clear();
+  OutputEncoder::create(OutputFormat::CSV)->encodeMovie(*casablanca, csv);
+  assert(csv.str() ==
+         "C,Casablanca,Michael Curtiz,1942,8,Ingrid Bergman;Humphrey Bogart,"
+         "20\n");
+  binary.clear();
+  OutputEncoder::create(OutputFormat::BINARY)->encodeMovie(*casablanca, binary);
+  bytes = binary.str();
+  at = 4 + 2 + 4 + 4 + 1;
+  assert(readString() == "Michael Curtiz" && readString() == "Casablanca");
+  assert(readInteger(1) == 2 && readString() == "Ingrid Bergman");
+  assert(readString() == "Humphrey Bogart" && at == bytes.size());
+
+  // A title too long for a u16 length is left out, not truncated
+  unique_ptr<Movie> oversized =
+      comedy(" 1, Jo Lee, " + string(70000, 'x') + ", 2001");
+  unique_ptr<OutputEncoder> encoder =
+      OutputEncoder::create(OutputFormat::BINARY);
+  FormatBuffer skipped;
+  encoder->encodeMovie(*oversized, skipped);
+  assert(skipped.size() == 0 && encoder->getSkipped() == 1);
+
+  // Transactions round-trip through each format, and the store reports
+  // the records it left out
+  stringstream sink;
+  Store store;
+  store.setOutput(sink, err);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+  assert(store.addMovie(move(quoted)));
+  assert(store.addMovie(move(oversized)));
+  assert(store.processCommandLine("B 1000 D F Say \"Cheese\", 2001"));
+  stringstream history;
+  store.displayCustomerHistory("1000", history, OutputFormat::JSON_LINES);
+  store.displayCustomerHistory("1000", history, OutputFormat::CSV);
+  assert(history.str() ==
+         "{\"customer\":\"1000\",\"type\":\"borrow\",\"sequence\":0,"
+         "\"genre\":\"F\",\"title\":\"Say \\\"Cheese\\\"\"}\n"
+         "customer,type,sequence,genre,title\n"
+         "1000,borrow,0,F,\"Say \"\"Cheese\"\"\"\n");
+  err.str("");
+  stringstream inventory;
+  store.displayInventory(inventory, OutputFormat::BINARY);
+  assert(err.str() == "Left out 1 records too large for the output format\n");
+  cout << "End testEncodedOutput" << endl;
+}
+
+void testSlicedReports() {
+  cout << "Start testSlicedReports" << endl;
+  BSTree<int> tree;
+  auto less = [](const int &a, const int &b) { return a < b; };
+  for (int value : {5, 2, 8, 1, 9, 3, 7}) {
+    tree.insert(value, less);
+  }
+  vector<int> walked;
+  for (BSTree<int>::Cursor cursor = tree.cursor(); !cursor.done();
+       cursor.advance()) {
+    walked.push_back(cursor.current());
+  }
+  assert((walked == vector<int>{1, 2, 3, 5, 7, 8, 9}));
+
+  stringstream sink;
+  Store store;
+  store.setOutput(sink, sink);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+  assert(store.processCommandLine("B 1000 D F You've Got Mail, 1998"));
+  Customer *customer = store.findCustomer("1000");
+  assert(customer != nullptr);
+
+  // One item per slice renders the same bytes as rendering in one go
+  for (OutputFormat format : {OutputFormat::TEXT, OutputFormat::JSON_LINES}) {
+    stringstream whole;
+    store.displayInventory(whole, format);
+    store.displayCustomerHistory("1000", whole, format);
+
+    FormatBuffer sliced;
+    unique_ptr<SlicedReport> report = store.startInventory(format);
+    while (!report->renderSlice(sliced, 1)) {
+    }
+    report = store.startCustomerHistory(*customer, format);
+    while (!report->renderSlice(sliced, 1)) {
+    }
+    assert(sliced.str() == whole.str());
+  }
+  cout << "End testSlicedReports" << endl;
+}
+
+void testCommandScheduler() {
+  cout << "Start testCommandScheduler" << endl;
+  stringstream sink;
+  Store store;
+  store.setOutput(sink, sink);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+
+  // A Borrow queued behind an Inventory finishes first
+  vector<string> finished;
+  string inventory;
+  {
+    CommandScheduler scheduler(store);
+    scheduler.submit("I", [&](const string &response, bool succeeded) {
+      assert(succeeded);
+      finished.push_back("I");
+      inventory = response;
+    });
+    scheduler.submit("B 1000 D F You've Got Mail, 1998",
+                     [&](const string &response, bool succeeded) {
+                       assert(succeeded);
+                       assert(response.compare(0, 13, "Debug: Borrow") == 0);
+                       finished.push_back("B");
+                     });
+    while (scheduler.runStep()) {
+    }
+    assert(scheduler.getShortLatency().getCount() == 1);
+  }
+  assert((finished == vector<string>{"B", "I"}));
+
+  // The store writes where it did before the scheduler took over
+  assert(&store.getOutput() == &sink && &store.getErrorOutput() == &sink);
+
+  stringstream expected;
+  expected << "==========================\n";
+  store.displayInventory(expected);
+  assert(inventory == expected.str());
+
+  // Errors a report writes while rendering reach its completion only
+  unique_ptr<Movie> oversized = MovieFactory::getInstance().createMovie('F');
+  stringstream data(" 1, Jo Lee, " + string(70000, 'x') + ", 2001");
+  assert(oversized->parseData(data));
+  assert(store.addMovie(move(oversized)));
+  string binary;
+  string borrow;
+  {
+    CommandScheduler scheduler(store);
+    scheduler.submit("I binary", [&](const string &response, bool) {
+      binary = response;
+    });
+    scheduler.submit("B 1000 D F Sleepless in Seattle, 1993",
+                     [&](const string &response, bool) {
+                       borrow = response;
+                     });
+    while (scheduler.runStep()) {
+    }
+  }
+  const string skipped = "Left out 1 records too large for the output format\n";
+  assert(binary.size() > skipped.size() &&
+         binary.compare(binary.size() - skipped.size(), string::npos,
+                        skipped) == 0);
+  assert(borrow.find("Left out") == string::npos);
+  cout << "End testCommandScheduler" << endl;
+}
+
+void testParallelInventory() {
+  cout << "Start testParallelInventory" << endl;
+  BSTree<int> tree;
+  auto less = [](const int &a, const int &b) { return a < b; };
+  for (int value = 0; value < 100; value++) {
+    tree.insert(value, less);
+  }
+  vector<int> walked;
+  for (const BSTree<int>::Range &range : tree.split(3)) {
+    tree.inOrderTraversal(range, [&](const int &value) {
+      walked.push_back(value);
+    });
+  }
+  assert(walked.size() == 100);
+  for (int value = 0; value < 100; value++) {
+    assert(walked[value] == value);
+  }
+
+  // Big enough to be split; rendered on three workers it matches the
+  // sequential output byte for byte
+  const string filename = "parallel-test.movies";
+  {
+    ofstream movies(filename);
+    for (int i = 0; i < 12000; i++) {
+      movies << "F, 10, Director " << i % 97 << ", Comedy " << i << ", "
+             << 1950 + i % 70 << "\n";
+      movies << "D, 10, Director " << i % 89 << ", Drama " << i << ", "
+             << 1940 + i % 80 << "\n";
+    }
+    movies << "C, 10, Michael Curtiz, Casablanca, Ingrid Bergman 8 1942\n";
+  }
+  stringstream sink;
+  Store sequential;
+  Store parallel;
+  sequential.setOutput(sink, sink);
+  parallel.setOutput(sink, sink);
+  parallel.useParallelRendering(3);
+  assert(sequential.initialize(filename, "data4customers.txt"));
+  assert(parallel.initialize(filename, "data4customers.txt"));
+  std::remove(filename.c_str());
+  for (OutputFormat format : {OutputFormat::TEXT, OutputFormat::JSON_LINES,
+                              OutputFormat::CSV, OutputFormat::BINARY}) {
+    stringstream expected;
+    stringstream actual;
+    sequential.displayInventory(expected, format);
+    parallel.displayInventory(actual, format);
+    assert(!expected.str().empty());
+    assert(actual.str() == expected.str());
+  }
+  cout << "End testParallelInventory" << endl;
+}
+
+#ifdef STORE_SERVER
+void testCommandServer() {
+  cout << "Start testCommandServer" << endl;
+  stringstream sink;
+  Store store;
+  store.setOutput(sink, sink);
+  assert(store.initialize("data4movies.txt", "data4customers.txt"));
+  for (const char *type = CommandServer::ADMIN_COMMANDS; *type != '\0';
+       type++) {
+    store.disableCommandType(*type);
+  }
+  const string socketPath = "server-test.sock";
+  CommandServer server(store);
+  assert(server.listen(socketPath));
+
+  // The server stops on SIGTERM through its signalfd, so no thread may
+  // take the signal itself
+  sigset_t signals;
+  sigset_t previous;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGTERM);
+  sigprocmask(SIG_BLOCK, &signals, &previous);
+
+  // An admin command is refused; a Borrow still runs
+  string response;
+  thread client([&]() {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(),
+            sizeof(address.sun_path) - 1);
+    assert(connect(fd, reinterpret_cast<sockaddr *>(&address),
+                   sizeof(address)) == 0);
+    const string request = "U C /etc/hostname\n"
+                           "B 1000 D F You've Got Mail, 1998\n";
+    assert(write(fd, request.data(), request.size()) ==
+           static_cast<ssize_t>(request.size()));
+    char buffer[4096];
+    size_t first;
+    while ((first = response.find("\n.\n")) == string::npos ||
+           response.find("\n.\n", first + 1) == string::npos) {
+      ssize_t count = read(fd, buffer, sizeof(buffer));
+      assert(count > 0);
+      response.append(buffer, static_cast<size_t>(count));
+    }
+    close(fd);
+    kill(getpid(), SIGTERM);
+  });
+  assert(server.run());
+  client.join();
+  sigprocmask(SIG_SETMASK, &previous, nullptr);
+
+  assert(response.compare(0, 23, "Unknown command type: U") == 0);
+  size_t borrow = response.find("\n.\n") + 3;
+  assert(response.compare(borrow, 13, "Debug: Borrow") == 0);
+  assert(response.find("/etc/hostname") == string::npos);
+  cout << "End testCommandServer" << endl;
+}
+#endif
+
 void testStoreFinal() {
   cout << "=====================================" << endl;
   cout << "Start testStoreFinal" << endl;
@@ -48,5 +1118,30 @@ void testStoreFinal() {
 void testAll() {
   testStore1();
   testStore2();
+  testCountMinSketch();
+  testLeaderboard();
+  testTrie();
+  testNameIndexes();
+  testConsolidatedRecords();
+  testFlatStorage();
+  testFilterStats();
+  testCatalogColumns();
+  testCompactTransaction();
+  testBSTreeErase();
+  testRetireThenReturn();
+  testCustomerIndexErase();
+  testWideCustomerIDs();
+  testCoRentalIndex();
+  testLatencyHistogram();
+  testTypeMask();
+  testCommandLog();
+  testDeltaCommand();
+  testEncodedOutput();
+  testSlicedReports();
+  testCommandScheduler();
+  testParallelInventory();
+#ifdef STORE_SERVER
+  testCommandServer();
+#endif
   testStoreFinal();
 }